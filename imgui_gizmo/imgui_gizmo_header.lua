@@ -45,6 +45,14 @@ function imgui_gizmo.is_over_operation(operation) end
 ---@return boolean
 function imgui_gizmo.is_over_position(position, radius) end
 
+---Batched is_over_position: the nearest position the mouse is over, in one call.
+---@param positions vector3[]|buffer table of positions, or a buffer with a float32 x 3 stream (read without copying)
+---@param radii number|number[]|string pixel radius for all positions, one per position, or the name of a float32 x 1 stream of the positions buffer
+---@param stream_name string|nil positions buffer stream name (default "position")
+---@return number|nil index 1-based index of the nearest hit, nil when the mouse is over none
+---@return number|nil distance pixel distance of that position to the mouse
+function imgui_gizmo.is_over_positions(positions, radii, stream_name) end
+
 ---Return true if gizmo is used.
 ---@return boolean
 function imgui_gizmo.is_using() end
@@ -79,9 +87,15 @@ function imgui_gizmo.set_axis_mask(x, y, z) end
 ---@param value number
 function imgui_gizmo.set_plane_limit(value) end
 
----Manipulate transform matrix.
+---Set the camera used when view or projection is nil in manipulate, manipulate_many, draw_grid, draw_cubes and view_manipulate (projection only).
+---View-dependent data is computed once here, call it each frame after the camera moved.
 ---@param view matrix4
 ---@param projection matrix4
+function imgui_gizmo.set_camera(view, projection) end
+
+---Manipulate transform matrix.
+---@param view matrix4|nil
+---@param projection matrix4|nil
 ---@param operation number
 ---@param mode number
 ---@param matrix matrix4
@@ -92,6 +106,33 @@ function imgui_gizmo.set_plane_limit(value) end
 ---@return matrix4|nil
 function imgui_gizmo.manipulate(view, projection, operation, mode, matrix, snap, local_bounds, bounds_snap) end
 
+---Manipulate a game object in place. Its world transform is read natively and the result is written back
+---as its local position, rotation and scale, with no matrix going through Lua.
+---@param url string|hash|url game object
+---@param view matrix4|nil
+---@param projection matrix4|nil
+---@param operation number
+---@param mode number
+---@param snap vector3|number|nil
+---@param local_bounds table|nil
+---@param bounds_snap vector3|number|nil
+---@return boolean manipulated
+function imgui_gizmo.manipulate_instance(url, view, projection, operation, mode, snap, local_bounds, bounds_snap) end
+
+---Manipulate several matrices with one gizmo placed at a pivot and oriented like the active matrix.
+---The same world space change is applied to every matrix in place.
+---@param view matrix4|nil
+---@param projection matrix4|nil
+---@param operation number
+---@param mode number
+---@param matrices matrix4[]
+---@param pivot number PIVOT_CENTROID, PIVOT_BOUNDS_CENTER or PIVOT_ACTIVE
+---@param active_index number|nil index of the active matrix (default 1)
+---@param snap vector3|number|nil
+---@return boolean
+---@return number[]|nil indices of the changed matrices
+function imgui_gizmo.manipulate_many(view, projection, operation, mode, matrices, pivot, active_index, snap) end
+
 ---Decompose matrix to translation, rotation (degrees), scale.
 ---@param matrix matrix4
 ---@return vector3
@@ -106,9 +147,23 @@ function imgui_gizmo.decompose_matrix(matrix) end
 ---@return matrix4
 function imgui_gizmo.recompose_matrix(translation, rotation, scale) end
 
+---Decompose matrix into existing vectors, without allocating.
+---@param matrix matrix4
+---@param out_translation vector3
+---@param out_rotation vector3 rotation in degrees
+---@param out_scale vector3
+function imgui_gizmo.decompose_matrix_into(matrix, out_translation, out_rotation, out_scale) end
+
+---Recompose matrix from translation, rotation (degrees), scale into an existing matrix, without allocating.
+---@param translation vector3
+---@param rotation vector3
+---@param scale vector3
+---@param out_matrix matrix4
+function imgui_gizmo.recompose_matrix_into(translation, rotation, scale, out_matrix) end
+
 ---Draw grid.
----@param view matrix4
----@param projection matrix4
+---@param view matrix4|nil
+---@param projection matrix4|nil
 ---@param matrix matrix4
 ---@param grid_size number
 function imgui_gizmo.draw_grid(view, projection, matrix, grid_size) end
@@ -120,11 +175,12 @@ function imgui_gizmo.draw_grid(view, projection, matrix, grid_size) end
 ---If numbers are used, they must be RGBA in 0xRRGGBBAA format.
 function imgui_gizmo.set_grid_colors(minor, major, axis) end
 
----Draw cubes from matrices array.
----@param view matrix4
----@param projection matrix4
----@param matrices table
-function imgui_gizmo.draw_cubes(view, projection, matrices) end
+---Draw cubes from matrices array, or from a buffer stream of float32 x 16 matrices (read without copying).
+---@param view matrix4|nil
+---@param projection matrix4|nil
+---@param matrices table|buffer
+---@param stream_name string|nil buffer stream name (default "matrix")
+function imgui_gizmo.draw_cubes(view, projection, matrices, stream_name) end
 
 ---View manipulate (camera gizmo).
 ---@param view matrix4
@@ -134,9 +190,9 @@ function imgui_gizmo.draw_cubes(view, projection, matrices) end
 ---@param background_color number
 function imgui_gizmo.view_manipulate(view, length, position, size, background_color) end
 
----View manipulate with projection and matrix.
+---View manipulate with projection and matrix. view is modified in place, projection can be nil.
 ---@param view matrix4
----@param projection matrix4
+---@param projection matrix4|nil
 ---@param operation number
 ---@param mode number
 ---@param matrix matrix4
@@ -146,6 +202,138 @@ function imgui_gizmo.view_manipulate(view, length, position, size, background_co
 ---@param background_color number
 function imgui_gizmo.view_manipulate(view, projection, operation, mode, matrix, length, position, size, background_color) end
 
+---Register a pickable box in the native picking scene.
+---@param matrix matrix4 world matrix of the object
+---@param min vector3 local box min
+---@param max vector3 local box max
+---@return number handle
+function imgui_gizmo.picking_add_aabb(matrix, min, max) end
+
+---Register a pickable sphere in the native picking scene.
+---@param matrix matrix4 world matrix of the object
+---@param center vector3 local sphere center
+---@param radius number local sphere radius
+---@return number handle
+function imgui_gizmo.picking_add_sphere(matrix, center, radius) end
+
+---Update the world matrix of a picking object. Cheap, the hierarchy is refit on the next pick.
+---@param handle number
+---@param matrix matrix4
+---@return boolean false when the handle is unknown
+function imgui_gizmo.picking_set_matrix(handle, matrix) end
+
+---Remove a picking object. Its handle can be returned again by picking_add_*.
+---@param handle number
+---@return boolean false when the handle is unknown
+function imgui_gizmo.picking_remove(handle) end
+
+---Remove all picking objects.
+function imgui_gizmo.picking_clear() end
+
+---Number of picking objects.
+---@return number
+function imgui_gizmo.picking_count() end
+
+---Nearest picking object under a screen position, using the camera from set_camera.
+---@param x number|nil ImGui screen x (default mouse position)
+---@param y number|nil ImGui screen y, top-down
+---@param max_distance number|nil world distance limit along the ray
+---@return number|nil handle nil when nothing is hit
+---@return number|nil distance world distance from the ray origin (the eye for perspective cameras)
+function imgui_gizmo.pick(x, y, max_distance) end
+
+---Box selection: picking objects whose world bounds touch the part of the camera frustum (from set_camera) seen
+---through a screen rectangle.
+---@param x0 number ImGui screen x of a corner
+---@param y0 number ImGui screen y of a corner, top-down
+---@param x1 number ImGui screen x of the opposite corner
+---@param y1 number ImGui screen y of the opposite corner
+---@param result table|nil table filled in place (entries after the new count are cleared), a new one when nil
+---@return table handles in no particular order
+---@return number count
+function imgui_gizmo.select_in_rect(x0, y0, x1, y1, result) end
+
+---Snap the gizmo origin to the nearest vertex of the vertex snap meshes during translate drags.
+---The vertex nearest to the mouse within pixel_radius is used, still constrained to the dragged axis or plane.
+---@param pixel_radius number|nil search radius in pixels, nil or 0 turns vertex snapping off
+function imgui_gizmo.set_vertex_snap(pixel_radius) end
+
+---Register mesh vertices for vertex snapping. The positions are copied and indexed once, moving the mesh is cheap.
+---@param matrix matrix4 world matrix of the mesh
+---@param positions vector3[]|buffer local positions, or a buffer with a float32 x 3 stream
+---@param stream_name string|nil positions buffer stream name (default "position")
+---@return number handle
+function imgui_gizmo.vertex_snap_add_mesh(matrix, positions, stream_name) end
+
+---Update the world matrix of a vertex snap mesh.
+---@param handle number
+---@param matrix matrix4
+---@return boolean false when the handle is unknown
+function imgui_gizmo.vertex_snap_set_matrix(handle, matrix) end
+
+---Include or skip a vertex snap mesh, for example to skip the mesh of the object being dragged.
+---@param handle number
+---@param enabled boolean
+---@return boolean false when the handle is unknown
+function imgui_gizmo.vertex_snap_set_enabled(handle, enabled) end
+
+---Remove a vertex snap mesh.
+---@param handle number
+---@return boolean false when the handle is unknown
+function imgui_gizmo.vertex_snap_remove(handle) end
+
+---Remove all vertex snap meshes.
+function imgui_gizmo.vertex_snap_clear() end
+
+---Place the gizmo origin on the surface meshes under the mouse during translate drags, instead of moving along the
+---dragged axis or plane. Vertex snapping, when on, wins over the surface.
+---@param enabled boolean
+---@param align_to_normal boolean|nil also turn the up axis of the matrix onto the surface normal
+function imgui_gizmo.set_surface_snap(enabled, align_to_normal) end
+
+---Register mesh triangles for surface placement. The triangles are copied and indexed once, moving the mesh is cheap.
+---@param matrix matrix4 world matrix of the mesh
+---@param positions vector3[]|buffer local positions, or a buffer with a float32 x 3 stream
+---@param indices number[]|nil 1-based vertex indices, 3 per triangle. nil when every 3 positions make a triangle
+---@param stream_name string|nil positions buffer stream name (default "position")
+---@return number handle
+function imgui_gizmo.surface_add_mesh(matrix, positions, indices, stream_name) end
+
+---New local positions for a surface mesh with the same vertex count, for deforming meshes. Cheaper than removing and adding it.
+---@param handle number
+---@param positions vector3[]|buffer
+---@param stream_name string|nil positions buffer stream name (default "position")
+---@return boolean false when the handle is unknown or the vertex count changed
+function imgui_gizmo.surface_update_mesh(handle, positions, stream_name) end
+
+---Update the world matrix of a surface mesh.
+---@param handle number
+---@param matrix matrix4
+---@return boolean false when the handle is unknown
+function imgui_gizmo.surface_set_matrix(handle, matrix) end
+
+---Include or skip a surface mesh, for example to skip the mesh of the object being dragged.
+---@param handle number
+---@param enabled boolean
+---@return boolean false when the handle is unknown
+function imgui_gizmo.surface_set_enabled(handle, enabled) end
+
+---Remove a surface mesh.
+---@param handle number
+---@return boolean false when the handle is unknown
+function imgui_gizmo.surface_remove(handle) end
+
+---Remove all surface meshes.
+function imgui_gizmo.surface_clear() end
+
+---Nearest surface mesh triangle under a screen position, using the camera from set_camera.
+---@param x number|nil ImGui screen x (default mouse position)
+---@param y number|nil ImGui screen y, top-down
+---@return number|nil handle nil when nothing is hit
+---@return vector3|nil position world position of the hit
+---@return vector3|nil normal world normal of the triangle, facing the camera
+function imgui_gizmo.surface_raycast(x, y) end
+
 ---Get style table.
 ---@return table
 function imgui_gizmo.get_style() end
@@ -154,6 +342,21 @@ function imgui_gizmo.get_style() end
 ---@param style table
 function imgui_gizmo.set_style(style) end
 
+---Store a named style preset: the current style with the fields of style applied. A preset with the same name is replaced.
+---@param name string
+---@param style table|nil same fields as set_style
+---@return number handle
+function imgui_gizmo.create_style(name, style) end
+
+---Find a style preset by name.
+---@param name string
+---@return number|nil handle
+function imgui_gizmo.find_style(name) end
+
+---Make a style preset the current style. Cheap enough to switch styles per viewport every frame.
+---@param handle number
+function imgui_gizmo.use_style(handle) end
+
 ---Get style color by index.
 ---@param index number
 ---@return vector4
@@ -164,6 +367,10 @@ function imgui_gizmo.get_style_color(index) end
 ---@param color vector4|table
 function imgui_gizmo.set_style_color(index, color) end
 
+---Largest number of bytes of per-frame scratch memory used so far.
+---@return number
+function imgui_gizmo.get_scratch_high_water() end
+
 ---Convert Euler degrees to quaternion.
 ---@param euler vector3
 ---@return quat
@@ -222,3 +429,7 @@ imgui_gizmo.COLOR_HATCHED_AXIS_LINES = 12
 imgui_gizmo.COLOR_TEXT = 13
 imgui_gizmo.COLOR_TEXT_SHADOW = 14
 imgui_gizmo.COLOR_COUNT = 15
+
+imgui_gizmo.PIVOT_CENTROID = 0
+imgui_gizmo.PIVOT_BOUNDS_CENTER = 1
+imgui_gizmo.PIVOT_ACTIVE = 2
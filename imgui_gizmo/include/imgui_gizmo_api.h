@@ -0,0 +1,103 @@
+// C API of the imgui_gizmo extension, for native extensions that want to drive the gizmo without going through Lua.
+//
+// Matrices are column-major float[16], the layout of dmVMath::Matrix4 and of ImGuizmo. All functions work on the same
+// ImGuizmo state as the Lua module: a camera bound here is used by Lua calls with a nil view/projection and the other
+// way around, and is_over/is_using see the gizmos drawn from both sides.
+// Call the functions from the thread running the ImGui frame, after the ImGui context was created.
+#ifndef IMGUI_GIZMO_API_H
+#define IMGUI_GIZMO_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMGUI_GIZMO_API_VERSION 1
+
+// values of imgui_gizmo.MODE_*
+enum ImGuiGizmoMode
+{
+    IMGUI_GIZMO_MODE_LOCAL = 0,
+    IMGUI_GIZMO_MODE_WORLD = 1
+};
+
+// values of imgui_gizmo.OPERATION_*, flags that can be combined
+enum ImGuiGizmoOperation
+{
+    IMGUI_GIZMO_OPERATION_TRANSLATE_X = 1 << 0,
+    IMGUI_GIZMO_OPERATION_TRANSLATE_Y = 1 << 1,
+    IMGUI_GIZMO_OPERATION_TRANSLATE_Z = 1 << 2,
+    IMGUI_GIZMO_OPERATION_ROTATE_X = 1 << 3,
+    IMGUI_GIZMO_OPERATION_ROTATE_Y = 1 << 4,
+    IMGUI_GIZMO_OPERATION_ROTATE_Z = 1 << 5,
+    IMGUI_GIZMO_OPERATION_ROTATE_SCREEN = 1 << 6,
+    IMGUI_GIZMO_OPERATION_SCALE_X = 1 << 7,
+    IMGUI_GIZMO_OPERATION_SCALE_Y = 1 << 8,
+    IMGUI_GIZMO_OPERATION_SCALE_Z = 1 << 9,
+    IMGUI_GIZMO_OPERATION_BOUNDS = 1 << 10,
+    IMGUI_GIZMO_OPERATION_SCALE_XU = 1 << 11,
+    IMGUI_GIZMO_OPERATION_SCALE_YU = 1 << 12,
+    IMGUI_GIZMO_OPERATION_SCALE_ZU = 1 << 13,
+
+    IMGUI_GIZMO_OPERATION_TRANSLATE = 7,
+    IMGUI_GIZMO_OPERATION_ROTATE = 120,
+    IMGUI_GIZMO_OPERATION_SCALE = 896,
+    IMGUI_GIZMO_OPERATION_SCALEU = 14336,
+    IMGUI_GIZMO_OPERATION_UNIVERSAL = 15359
+};
+
+// values of imgui_gizmo.PIVOT_*
+enum ImGuiGizmoPivot
+{
+    IMGUI_GIZMO_PIVOT_CENTROID = 0,
+    IMGUI_GIZMO_PIVOT_BOUNDS_CENTER = 1,
+    IMGUI_GIZMO_PIVOT_ACTIVE = 2
+};
+
+// Context setup
+// imgui_context is an ImGuiContext*, NULL uses the current ImGui context. Returns 0 when there is no context.
+int imgui_gizmo_set_context(void* imgui_context);
+void imgui_gizmo_set_rect(float x, float y, float width, float height);
+void imgui_gizmo_set_orthographic(int is_orthographic);
+// draw_list is an ImDrawList*, NULL draws in the gizmo window
+void imgui_gizmo_set_drawlist(void* draw_list);
+void imgui_gizmo_set_drawlist_foreground(void);
+void imgui_gizmo_set_drawlist_background(void);
+
+// Camera used when view or projection is NULL in the functions below
+void imgui_gizmo_set_camera(const float* view, const float* projection);
+int imgui_gizmo_has_camera(void);
+
+// Manipulation, return non-zero when the matrix was modified.
+// delta_matrix, snap (float[3]), local_bounds (float[6]) and bounds_snap (float[3]) can be NULL.
+int imgui_gizmo_manipulate(const float* view, const float* projection, int operation, int mode, float* matrix,
+    float* delta_matrix, const float* snap, const float* local_bounds, const float* bounds_snap);
+// matrix_count consecutive float[16] matrices, changed (matrix_count entries) and snap can be NULL
+int imgui_gizmo_manipulate_many(const float* view, const float* projection, int operation, int mode, float* matrices,
+    int matrix_count, int pivot, int active_index, uint8_t* changed, const float* snap);
+// view is modified in place, background_color is 0xAABBGGRR (ImU32)
+void imgui_gizmo_view_manipulate(float* view, float length, float x, float y, float width, float height, uint32_t background_color);
+
+// Draw helpers
+void imgui_gizmo_draw_grid(const float* view, const float* projection, const float* matrix, float grid_size);
+// matrix_stride is the distance in floats between matrices, 16 for packed matrices
+void imgui_gizmo_draw_cubes(const float* view, const float* projection, const float* matrices, int matrix_count, int matrix_stride);
+
+// Hover and state queries, about the gizmos drawn this frame
+int imgui_gizmo_is_over(void);
+int imgui_gizmo_is_over_operation(int operation);
+int imgui_gizmo_is_over_position(const float* position, float pixel_radius);
+// index of the nearest of count positions (position_stride floats apart) the mouse is over, -1 for none.
+// pixel_radii (radius_stride floats apart) can be NULL to use pixel_radius for all, distance can be NULL.
+int imgui_gizmo_is_over_positions(const float* positions, int count, int position_stride, const float* pixel_radii,
+    int radius_stride, float pixel_radius, float* distance);
+int imgui_gizmo_is_using(void);
+int imgui_gizmo_is_using_any(void);
+int imgui_gizmo_is_using_view_manipulate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMGUI_GIZMO_API_H
@@ -121,9 +121,12 @@ namespace IMGUIZMO_NAMESPACE
 {
    // call inside your own window and before Manipulate() in order to draw gizmo to that window.
    // Or pass a specific ImDrawList to draw to (e.g. ImGui::GetForegroundDrawList()).
+   // The drawlist stays in use until the end of the current ImGui frame.
    IMGUI_API void SetDrawlist(ImDrawList* drawlist = nullptr);
 
    // call BeginFrame right after ImGui_XXXX_NewFrame();
+   // extra calls within the same ImGui frame are ignored. The full screen "gizmo" window is only
+   // created when something is drawn in a frame without a drawlist set through SetDrawlist.
    IMGUI_API void BeginFrame();
 
    // this is necessary because when imguizmo is compiled into a dll, and imgui into another
@@ -167,13 +170,26 @@ namespace IMGUIZMO_NAMESPACE
    // default is false
    IMGUI_API void SetOrthographic(bool isOrthographic);
 
+   // Camera used when a view or projection parameter is NULL. The view-dependent data (view * projection, inverses,
+   // reversed depth, camera basis) is computed here once, call it after the camera moved and before the gizmos.
+   IMGUI_API void SetCamera(const float* view, const float* projection);
+   // true once SetCamera was called
+   IMGUI_API bool HasCamera();
+   // world space ray through a screen position (same coordinates as the mouse) for the camera given to SetCamera.
+   // Perspective rays start at the eye, orthographic ones in front of the whole clip range. rayDirection is normalized.
+   IMGUI_API void ComputeRay(ImVec2 screenPos, float* rayOrigin, float* rayDirection);
+   // 6 world space planes (a, b, c, d, inside when a * x + b * y + c * z + d >= 0) of the part of the SetCamera frustum
+   // seen through a screen rectangle, corners in any order. For box selection
+   IMGUI_API void ComputeRectFrustum(ImVec2 screenMin, ImVec2 screenMax, float* planes);
+
    // Render a cube with face color corresponding to face normal. Usefull for debug/tests
-   IMGUI_API void DrawCubes(const float* view, const float* projection, const float* matrices, int matrixCount);
+   // matrixStride is the distance in floats between consecutive matrices, for matrices interleaved with other data
+   IMGUI_API void DrawCubes(const float* view, const float* projection, const float* matrices, int matrixCount, int matrixStride = 16);
    IMGUI_API void DrawGrid(const float* view, const float* projection, const float* matrix, const float gridSize);
    IMGUI_API void SetGridColors(ImU32 minor, ImU32 major, ImU32 axis);
 
    // call it when you want a gizmo
-   // Needs view and projection matrices. 
+   // Needs view and projection matrices, NULL uses the ones given to SetCamera.
    // matrix parameter is the source matrix (where will be gizmo be drawn) and might be transformed by the function. Return deltaMatrix is optional
    // translation is applied in world space
    enum OPERATION
@@ -212,6 +228,18 @@ namespace IMGUIZMO_NAMESPACE
    };
 
    IMGUI_API bool Manipulate(const float* view, const float* projection, OPERATION operation, MODE mode, float* matrix, float* deltaMatrix = NULL, const float* snap = NULL, const float* localBounds = NULL, const float* boundsSnap = NULL);
+
+   enum PIVOT
+   {
+      CENTROID,      // mean of the matrix positions
+      BOUNDS_CENTER, // center of the box around the matrix positions
+      ACTIVE         // position of the active matrix
+   };
+
+   // one gizmo for matrixCount consecutive float[16] matrices. It sits at the pivot, oriented like matrices[activeIndex],
+   // and the world space change it makes is applied to every matrix. changed (optional, matrixCount entries) tells
+   // which matrices were modified by this call.
+   IMGUI_API bool ManipulateMany(const float* view, const float* projection, OPERATION operation, MODE mode, float* matrices, int matrixCount, PIVOT pivot, int activeIndex = 0, bool* changed = NULL, const float* snap = NULL);
    //
    // Please note that this cubeview is patented by Autodesk : https://patents.google.com/patent/US7782319B2/en
    // It seems to be a defensive patent in the US. I don't think it will bring troubles using it as
@@ -220,6 +248,7 @@ namespace IMGUIZMO_NAMESPACE
    IMGUI_API void ViewManipulate(float* view, float length, ImVec2 position, ImVec2 size, ImU32 backgroundColor);
 
    // use this version if you did not call Manipulate before and you are just using ViewManipulate
+   // view is modified in place and can't be NULL, projection can
    IMGUI_API void ViewManipulate(float* view, const float* projection, OPERATION operation, MODE mode, float* matrix, float length, ImVec2 position, ImVec2 size, ImU32 backgroundColor);
 
    IMGUI_API void SetAlternativeWindow(ImGuiWindow* window);
@@ -264,6 +293,11 @@ namespace IMGUIZMO_NAMESPACE
    IMGUI_API void SetPlaneLimit(float value);
    // from a x,y,z point in space and using Manipulation view/projection matrix, check if mouse is in pixel radius distance of that projected point
    IMGUI_API bool IsOver(float* position, float pixelRadius);
+   // batched IsOver for count positions, positionStride floats apart. Each position has its own radius from pixelRadii
+   // (radiusStride floats apart) or pixelRadius when pixelRadii is NULL. Returns the index of the nearest position the
+   // mouse is over and its pixel distance in distance (optional), -1 when the mouse is over none. Positions behind
+   // the camera are skipped.
+   IMGUI_API int IsOverPositions(const float* positions, int count, int positionStride, const float* pixelRadii, int radiusStride, float pixelRadius, float* distance = NULL);
 
    enum COLOR
    {
@@ -297,9 +331,46 @@ namespace IMGUIZMO_NAMESPACE
       float ScaleLineCircleSize;        // Size of circle at the end of lines for scale gizmo
       float HatchedAxisLineThickness;   // Thickness of hatched axis lines
       float CenterCircleSize;           // Size of circle at the center of the translate/scale gizmo
+      float CircleTessellationMaxError; // Maximum distance in pixels between drawn rotation circles and the true circle, 0 always uses the full segment count
 
       ImVec4 Colors[COLOR::COUNT];
    };
 
+   // Writes through the returned style are picked up after the next GetStyle() or BeginFrame(). The colors are only
+   // repacked when they differ from the ones packed last
    IMGUI_API Style& GetStyle();
+
+   // Named style presets. CreateStyle stores a copy of style (replacing a preset with the same name) and returns its handle,
+   // UseStyle makes a preset the current style without repacking its colors. FindStyle returns -1 for an unknown name.
+   IMGUI_API int CreateStyle(const char* name, const Style& style);
+   IMGUI_API int FindStyle(const char* name);
+   IMGUI_API bool UseStyle(int handle);
+
+   // Translation snap hook, called on every update of a translate drag after the axis constraint and the snap steps
+   struct TranslationSnapQuery
+   {
+      float position[3];        // world position the gizmo origin is about to move to
+      float viewProjection[16]; // camera of the dragged gizmo
+      ImVec2 rectPosition;      // rect given to SetRect
+      ImVec2 rectSize;
+      ImVec2 mousePos;
+      float rayOrigin[3];       // world ray under the mouse, pointing away from the viewer
+      float rayDirection[3];    // normalized
+   };
+   struct TranslationSnapResult
+   {
+      float position[3];        // world position to move to
+      float surfaceNormal[3];   // zero for a snap: the dragged axis or plane still constrains the position.
+                                // A world normal places the gizmo on a surface: the position is used as is
+      bool alignToSurface;      // also turn the up axis of the matrix onto surfaceNormal
+   };
+   // Fill result (zeroed before the call) and return true to move there instead. NULL removes the hook
+   typedef bool (*TranslationSnapCallback)(const TranslationSnapQuery* query, TranslationSnapResult* result, void* userData);
+   IMGUI_API void SetTranslationSnapCallback(TranslationSnapCallback callback, void* userData = NULL);
+
+   // Frame-scoped scratch memory, 16-byte aligned. Valid until the next ImGui frame, never freed by the caller.
+   // The arena keeps its memory between frames, so a steady workload stops allocating after the first frame.
+   IMGUI_API void* ScratchAlloc(size_t size);
+   // Largest number of scratch bytes used in a single frame so far
+   IMGUI_API size_t GetScratchHighWaterMark();
 }
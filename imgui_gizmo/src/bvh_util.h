@@ -0,0 +1,207 @@
+#pragma once
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <vector>
+
+// Internal helpers shared by the native picking, surface and vertex snap modules: the node layout of their
+// bounding volume hierarchies, bounds and ray tests, affine inverses and the handle table behind the Lua handles.
+// Matrices are column-major float[16] like ImGuizmo.
+
+namespace Bvh
+{
+    struct Node
+    {
+        float min[3];
+        int first; // leaf: first item, internal: left child, right child is first + 1
+        float max[3];
+        int count; // items in a leaf, 0 for internal nodes
+    };
+
+    // plain compares, fminf/fmaxf are library calls unless NaN handling is disabled
+    inline float Min(float a, float b)
+    {
+        return a < b ? a : b;
+    }
+
+    inline float Max(float a, float b)
+    {
+        return a > b ? a : b;
+    }
+
+    inline void ClearBounds(float* min, float* max)
+    {
+        min[0] = min[1] = min[2] = FLT_MAX;
+        max[0] = max[1] = max[2] = -FLT_MAX;
+    }
+
+    inline void GrowBounds(float* min, float* max, const float* other_min, const float* other_max)
+    {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = Min(min[i], other_min[i]);
+            max[i] = Max(max[i], other_max[i]);
+        }
+    }
+
+    // half the surface area, 0 for cleared bounds
+    inline float Area(const float* min, const float* max)
+    {
+        float dx = max[0] - min[0];
+        float dy = max[1] - min[1];
+        float dz = max[2] - min[2];
+        if (dx < 0.0f || dy < 0.0f || dz < 0.0f) {
+            return 0.0f;
+        }
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    inline void TransformPoint(const float* m, const float* p, float* out)
+    {
+        for (int i = 0; i < 3; ++i) {
+            out[i] = m[i] * p[0] + m[4 + i] * p[1] + m[8 + i] * p[2] + m[12 + i];
+        }
+    }
+
+    inline void TransformVector(const float* m, const float* v, float* out)
+    {
+        for (int i = 0; i < 3; ++i) {
+            out[i] = m[i] * v[0] + m[4 + i] * v[1] + m[8 + i] * v[2];
+        }
+    }
+
+    // inverse of the affine part of a column-major matrix, false when it is singular
+    inline bool InverseAffine(const float* m, float* out)
+    {
+        float c00 = m[5] * m[10] - m[9] * m[6];
+        float c01 = m[9] * m[2] - m[1] * m[10];
+        float c02 = m[1] * m[6] - m[5] * m[2];
+        float det = m[0] * c00 + m[4] * c01 + m[8] * c02;
+        if (fabsf(det) < 1e-20f) {
+            return false;
+        }
+        float inv_det = 1.0f / det;
+        out[0] = c00 * inv_det;
+        out[1] = c01 * inv_det;
+        out[2] = c02 * inv_det;
+        out[4] = (m[8] * m[6] - m[4] * m[10]) * inv_det;
+        out[5] = (m[0] * m[10] - m[8] * m[2]) * inv_det;
+        out[6] = (m[4] * m[2] - m[0] * m[6]) * inv_det;
+        out[8] = (m[4] * m[9] - m[8] * m[5]) * inv_det;
+        out[9] = (m[8] * m[1] - m[0] * m[9]) * inv_det;
+        out[10] = (m[0] * m[5] - m[4] * m[1]) * inv_det;
+        out[3] = out[7] = out[11] = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            out[12 + i] = -(out[i] * m[12] + out[4 + i] * m[13] + out[8 + i] * m[14]);
+        }
+        out[15] = 1.0f;
+        return true;
+    }
+
+    // entry distance of the ray into a box, FLT_MAX when missed or farther than max_distance
+    inline float RayBox(const float* origin, const float* inv_direction, const float* min, const float* max, float max_distance)
+    {
+        float t_enter = 0.0f;
+        float t_exit = max_distance;
+        for (int i = 0; i < 3; ++i) {
+            float t0 = (min[i] - origin[i]) * inv_direction[i];
+            float t1 = (max[i] - origin[i]) * inv_direction[i];
+            t_enter = fmaxf(t_enter, fminf(t0, t1));
+            t_exit = fminf(t_exit, fmaxf(t0, t1));
+        }
+        return t_enter <= t_exit ? t_enter : FLT_MAX;
+    }
+
+    // visits the leaves the ray enters nearer than best, nearer child first so visit_leaf(node) can lower best
+    // and skip the farther ones. STACK_SIZE is the deepest leaf depth of the hierarchy plus 2
+    template <int STACK_SIZE, typename VisitLeaf>
+    inline void RaycastNodes(const Node* nodes, const float* origin, const float* inv_direction, const float& best, VisitLeaf visit_leaf)
+    {
+        if (RayBox(origin, inv_direction, nodes[0].min, nodes[0].max, best) == FLT_MAX) {
+            return;
+        }
+        int stack[STACK_SIZE];
+        int stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size) {
+            const Node& node = nodes[stack[--stack_size]];
+            if (node.count) {
+                visit_leaf(node);
+                continue;
+            }
+            int near_child = node.first;
+            int far_child = node.first + 1;
+            float t_near = RayBox(origin, inv_direction, nodes[near_child].min, nodes[near_child].max, best);
+            float t_far = RayBox(origin, inv_direction, nodes[far_child].min, nodes[far_child].max, best);
+            if (t_far < t_near) {
+                std::swap(near_child, far_child);
+                std::swap(t_near, t_far);
+            }
+            if (t_far < FLT_MAX) {
+                stack[stack_size++] = far_child;
+            }
+            if (t_near < FLT_MAX) {
+                stack[stack_size++] = near_child;
+            }
+        }
+    }
+
+    // positive handles to the index of an item in an array owned by the module, handle 0 is never used
+    struct HandleTable
+    {
+        std::vector<int> index; // handle to item index, -1 for a free handle
+        std::vector<int> free_handles;
+
+        int Allocate(int item_index)
+        {
+            int handle;
+            if (!free_handles.empty()) {
+                handle = free_handles.back();
+                free_handles.pop_back();
+            } else {
+                if (index.empty()) {
+                    index.push_back(-1);
+                }
+                handle = (int)index.size();
+                index.push_back(-1);
+            }
+            index[handle] = item_index;
+            return handle;
+        }
+
+        void Release(int handle)
+        {
+            index[handle] = -1;
+            free_handles.push_back(handle);
+        }
+
+        // item index of a live handle, -1 for anything else
+        int Find(int handle) const
+        {
+            if (handle <= 0 || handle >= (int)index.size()) {
+                return -1;
+            }
+            return index[handle];
+        }
+
+        void Clear()
+        {
+            index.clear();
+            free_handles.clear();
+        }
+    };
+
+    // removes the item of a live handle from a dense array by moving the last item into its place,
+    // items keep their own handle in a handle member
+    template <typename T>
+    inline void SwapRemove(std::vector<T>& items, HandleTable& handles, int handle)
+    {
+        int index = handles.index[handle];
+        if (index != (int)items.size() - 1) {
+            std::swap(items[index], items.back());
+            handles.index[items[index].handle] = index;
+        }
+        items.pop_back();
+        handles.Release(handle);
+    }
+}
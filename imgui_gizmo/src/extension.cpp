@@ -2,14 +2,18 @@
 #define LIB_NAME "ImguiGizmo"
 #define MODULE_NAME "imgui_gizmo"
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
 #include <math.h>
-#include <vector>
+#include <float.h>
 
 #include <dmsdk/sdk.h>
 
 #include "imgui.h"
 #include "imguizmo.h"
+#include "picking.h"
+#include "vertex_snap.h"
+#include "surface.h"
 
 
 static void Matrix4ToFloatArray(const dmVMath::Matrix4& matrix, float* out_array)
@@ -185,6 +189,98 @@ static void FloatArrayToMatrix4(const float* array, dmVMath::Matrix4* out_matrix
     );
 }
 
+// dmVMath::Matrix4 is four column Vector4s, the column-major float[16] ImGuizmo works on. When the layout
+// matches, bindings pass the userdata memory straight to ImGuizmo and results land in place.
+// Define IMGUI_GIZMO_MATRIX4_COPY to always copy through float arrays.
+#if !defined(IMGUI_GIZMO_MATRIX4_COPY)
+static_assert(sizeof(dmVMath::Vector4) == 4 * sizeof(float), "dmVMath::Vector4 is not 4 packed floats, define IMGUI_GIZMO_MATRIX4_COPY");
+static_assert(sizeof(dmVMath::Matrix4) == 16 * sizeof(float), "dmVMath::Matrix4 is not 16 packed floats, define IMGUI_GIZMO_MATRIX4_COPY");
+#endif
+
+// element order is checked once at init, a mismatch falls back to copies
+static bool g_Matrix4ZeroCopy = false;
+
+static void VerifyMatrix4Layout()
+{
+#if !defined(IMGUI_GIZMO_MATRIX4_COPY)
+    dmVMath::Matrix4 probe(
+        dmVMath::Vector4(0.0f, 1.0f, 2.0f, 3.0f),
+        dmVMath::Vector4(4.0f, 5.0f, 6.0f, 7.0f),
+        dmVMath::Vector4(8.0f, 9.0f, 10.0f, 11.0f),
+        dmVMath::Vector4(12.0f, 13.0f, 14.0f, 15.0f)
+    );
+    float expected[16];
+    Matrix4ToFloatArray(probe, expected);
+    g_Matrix4ZeroCopy = memcmp(&probe, expected, sizeof(expected)) == 0;
+#endif
+}
+
+// float[16] view of a matrix: the matrix itself on the zero-copy path, otherwise a copy in storage
+static float* Matrix4Floats(dmVMath::Matrix4* matrix, float* storage)
+{
+    if (g_Matrix4ZeroCopy) {
+        return (float*)matrix;
+    }
+    Matrix4ToFloatArray(*matrix, storage);
+    return storage;
+}
+
+static const float* Matrix4Floats(const dmVMath::Matrix4* matrix, float* storage)
+{
+    return Matrix4Floats((dmVMath::Matrix4*)matrix, storage);
+}
+
+// float[16] to fully overwrite a matrix with, store it back with Matrix4Store
+static float* Matrix4Target(dmVMath::Matrix4* matrix, float* storage)
+{
+    return g_Matrix4ZeroCopy ? (float*)matrix : storage;
+}
+
+// writes a float[16] from Matrix4Floats or Matrix4Target back to its matrix, nothing to do when it already is the matrix
+static void Matrix4Store(const float* values, dmVMath::Matrix4* matrix)
+{
+    if (values != (const float*)matrix) {
+        FloatArrayToMatrix4(values, matrix);
+    }
+}
+
+// view or projection argument: nil gives NULL so ImGuizmo uses the camera from set_camera
+static const float* CameraMatrix(lua_State* L, int index, float* storage)
+{
+    if (lua_isnil(L, index)) {
+        if (!ImGuizmo::HasCamera()) {
+            luaL_error(L, "view and projection are required until set_camera is called");
+        }
+        return NULL;
+    }
+    return Matrix4Floats(dmScript::CheckMatrix4(L, index), storage);
+}
+
+// float32 buffer stream with the given component count, read in place. stride is in floats
+static bool GetBufferFloats(lua_State* L, int index, const char* stream_name, uint32_t required_components, const float** out_values, int* out_count, int* out_stride)
+{
+    dmBuffer::HBuffer buffer = dmScript::CheckBuffer(L, index)->m_Buffer;
+    dmhash_t stream = dmHashString64(stream_name);
+
+    dmBuffer::ValueType type;
+    uint32_t components = 0;
+    if (dmBuffer::GetStreamType(buffer, stream, &type, &components) != dmBuffer::RESULT_OK ||
+        type != dmBuffer::VALUE_TYPE_FLOAT32 || components != required_components) {
+        return false;
+    }
+
+    void* data = NULL;
+    uint32_t count = 0;
+    uint32_t stride = 0;
+    if (dmBuffer::GetStream(buffer, stream, &data, &count, &components, &stride) != dmBuffer::RESULT_OK) {
+        return false;
+    }
+    *out_values = (const float*)data;
+    *out_count = (int)count;
+    *out_stride = (int)stride;
+    return true;
+}
+
 static bool ReadVector3(lua_State* L, int index, float out_vec[3])
 {
     if (!dmScript::IsVector3(L, index)) {
@@ -197,6 +293,39 @@ static bool ReadVector3(lua_State* L, int index, float out_vec[3])
     return true;
 }
 
+// positions at index: a table of vmath.vector3 copied to scratch memory, or a float32 x 3 buffer stream read in
+// place. false with a message in error when neither, so callers can raise it through DM_LUA_ERROR
+static bool ReadPositions(lua_State* L, int index, const char* stream_name, const float** out_positions, int* out_count, int* out_stride,
+    char* error, size_t error_size)
+{
+    if (dmScript::IsBuffer(L, index)) {
+        if (!GetBufferFloats(L, index, stream_name, 3, out_positions, out_count, out_stride)) {
+            snprintf(error, error_size, "buffer stream '%s' must be float32 with 3 components", stream_name);
+            return false;
+        }
+        return true;
+    }
+    if (!lua_istable(L, index)) {
+        snprintf(error, error_size, "positions must be a table of vmath.vector3 or a buffer");
+        return false;
+    }
+    int count = (int)lua_objlen(L, index);
+    float* values = (float*)ImGuizmo::ScratchAlloc((size_t)count * 3 * sizeof(float));
+    for (int i = 0; i < count; ++i) {
+        lua_rawgeti(L, index, i + 1);
+        bool valid = ReadVector3(L, -1, values + (size_t)i * 3);
+        lua_pop(L, 1);
+        if (!valid) {
+            snprintf(error, error_size, "positions[%d] must be vmath.vector3", i + 1);
+            return false;
+        }
+    }
+    *out_positions = values;
+    *out_count = count;
+    *out_stride = 3;
+    return true;
+}
+
 static bool ReadVector3OrNumber(lua_State* L, int index, float out_vec[3])
 {
     if (lua_isnumber(L, index)) {
@@ -299,6 +428,57 @@ static int gizmo_IsOverPosition(lua_State* L)
     return 1;
 }
 
+static int gizmo_IsOverPositions(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 2);
+    const float* positions = NULL;
+    int count = 0;
+    int position_stride = 3;
+    bool is_buffer = dmScript::IsBuffer(L, 1);
+    char error[128];
+    if (!ReadPositions(L, 1, luaL_optstring(L, 3, "position"), &positions, &count, &position_stride, error, sizeof(error))) {
+        return DM_LUA_ERROR("%s", error);
+    }
+
+    const float* radii = NULL;
+    int radius_stride = 1;
+    float radius = 0.0f;
+    if (lua_type(L, 2) == LUA_TNUMBER) {
+        radius = (float)lua_tonumber(L, 2);
+    } else if (lua_type(L, 2) == LUA_TSTRING && is_buffer) {
+        const char* radius_stream = lua_tostring(L, 2);
+        int radius_count = 0;
+        if (!GetBufferFloats(L, 1, radius_stream, 1, &radii, &radius_count, &radius_stride)) {
+            return DM_LUA_ERROR("buffer stream '%s' must be float32 with 1 component", radius_stream);
+        }
+        count = radius_count < count ? radius_count : count;
+    } else if (lua_istable(L, 2)) {
+        if ((int)lua_objlen(L, 2) < count) {
+            return DM_LUA_ERROR("radii must have one number per position");
+        }
+        float* values = (float*)ImGuizmo::ScratchAlloc((size_t)count * sizeof(float));
+        for (int i = 0; i < count; ++i) {
+            lua_rawgeti(L, 2, i + 1);
+            values[i] = (float)lua_tonumber(L, -1);
+            lua_pop(L, 1);
+        }
+        radii = values;
+    } else {
+        return DM_LUA_ERROR("radii must be a number, a table of numbers or a stream name of the positions buffer");
+    }
+
+    float distance = 0.0f;
+    int index = ImGuizmo::IsOverPositions(positions, count, position_stride, radii, radius_stride, radius, &distance);
+    if (index < 0) {
+        lua_pushnil(L);
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, index + 1);
+        lua_pushnumber(L, distance);
+    }
+    return 2;
+}
+
 static int gizmo_IsUsing(lua_State* L)
 {
     DM_LUA_STACK_CHECK(L, 1);
@@ -362,6 +542,46 @@ static int gizmo_SetPlaneLimit(lua_State* L)
     return 0;
 }
 
+// optional snap, local_bounds and bounds_snap arguments of manipulate starting at index, NULL when absent
+struct ManipulateOptions
+{
+    const float* snap;
+    const float* local_bounds;
+    const float* bounds_snap;
+    float snap_values[3];
+    float local_bounds_values[6];
+    float bounds_snap_values[3];
+};
+
+static void ReadManipulateOptions(lua_State* L, int index, ManipulateOptions* options)
+{
+    int top = lua_gettop(L);
+    options->snap = NULL;
+    options->local_bounds = NULL;
+    options->bounds_snap = NULL;
+
+    if (top >= index && !lua_isnil(L, index)) {
+        if (!ReadVector3OrNumber(L, index, options->snap_values)) {
+            luaL_error(L, "snap must be number or vmath.vector3");
+        }
+        options->snap = options->snap_values;
+    }
+
+    if (top >= index + 1 && !lua_isnil(L, index + 1)) {
+        if (!ReadBounds(L, index + 1, options->local_bounds_values)) {
+            luaL_error(L, "local_bounds must be table with 6 numbers");
+        }
+        options->local_bounds = options->local_bounds_values;
+    }
+
+    if (top >= index + 2 && !lua_isnil(L, index + 2)) {
+        if (!ReadVector3OrNumber(L, index + 2, options->bounds_snap_values)) {
+            luaL_error(L, "bounds_snap must be number or vmath.vector3");
+        }
+        options->bounds_snap = options->bounds_snap_values;
+    }
+}
+
 static int gizmo_Manipulate(lua_State* L)
 {
     int top = lua_gettop(L);
@@ -369,77 +589,213 @@ static int gizmo_Manipulate(lua_State* L)
         return luaL_error(L, "manipulate(view, projection, operation, mode, matrix, [snap], [local_bounds], [bounds_snap])");
     }
     ImGuizmo::BeginFrame();
-    dmVMath::Matrix4 view = *dmScript::CheckMatrix4(L, 1);
-    dmVMath::Matrix4 projection = *dmScript::CheckMatrix4(L, 2);
     ImGuizmo::OPERATION operation = (ImGuizmo::OPERATION)luaL_checkinteger(L, 3);
     ImGuizmo::MODE mode = (ImGuizmo::MODE)luaL_checkinteger(L, 4);
     dmVMath::Matrix4* gizmo_matrix = dmScript::CheckMatrix4(L, 5);
 
-    float view_matrix[16];
-    float projection_matrix[16];
-    float model_matrix[16];
-    float delta_matrix[16];
-    Matrix4ToFloatArray(view, view_matrix);
-    Matrix4ToFloatArray(projection, projection_matrix);
-    Matrix4ToFloatArray(*gizmo_matrix, model_matrix);
+    float view_storage[16];
+    float projection_storage[16];
+    float model_storage[16];
+    float delta_storage[16];
+    dmVMath::Matrix4 delta;
+    const float* view_matrix = CameraMatrix(L, 1, view_storage);
+    const float* projection_matrix = CameraMatrix(L, 2, projection_storage);
+    float* model_matrix = Matrix4Floats(gizmo_matrix, model_storage);
+    float* delta_matrix = Matrix4Target(&delta, delta_storage);
+
+    ManipulateOptions options;
+    ReadManipulateOptions(L, 6, &options);
+
+    bool manipulated = ImGuizmo::Manipulate(
+        view_matrix,
+        projection_matrix,
+        operation,
+        mode,
+        model_matrix,
+        delta_matrix,
+        options.snap,
+        options.local_bounds,
+        options.bounds_snap
+    );
+
+    Matrix4Store(model_matrix, gizmo_matrix);
+
+    lua_pushboolean(L, manipulated);
+    if (manipulated) {
+        Matrix4Store(delta_matrix, &delta);
+        dmScript::PushMatrix4(L, delta);
+        return 2;
+    }
+    return 1;
+}
+
+// world matrix built from the local transform, so transforms set earlier in the frame are already included
+static dmVMath::Matrix4 GetInstanceWorldMatrix(dmGameObject::HInstance instance)
+{
+    dmVMath::Matrix4 local = dmVMath::Matrix4(dmGameObject::GetRotation(instance), dmVMath::Vector3(dmGameObject::GetPosition(instance)))
+        * dmVMath::Matrix4::scale(dmGameObject::GetScale(instance));
+    dmGameObject::HInstance parent = dmGameObject::GetParent(instance);
+    return parent ? dmGameObject::GetWorldMatrix(parent) * local : local;
+}
+
+// writes a world matrix back as the instance's local position, rotation and scale
+static void SetInstanceWorldMatrix(dmGameObject::HInstance instance, const dmVMath::Matrix4& world)
+{
+    dmGameObject::HInstance parent = dmGameObject::GetParent(instance);
+    dmVMath::Matrix4 local = parent ? dmVMath::affineInverse(dmGameObject::GetWorldMatrix(parent)) * world : world;
+
+    dmVMath::Vector3 axis[3] = { local.getCol0().getXYZ(), local.getCol1().getXYZ(), local.getCol2().getXYZ() };
+    float scale[3];
+    for (int i = 0; i < 3; ++i) {
+        scale[i] = dmVMath::length(axis[i]);
+    }
+    // a mirrored basis keeps a proper rotation, the mirror goes to the x scale
+    if (dmVMath::dot(Cross(axis[0], axis[1]), axis[2]) < 0.0f) {
+        scale[0] = -scale[0];
+    }
+
+    dmGameObject::SetPosition(instance, dmVMath::Point3(local.getCol3().getXYZ()));
+    dmGameObject::SetScale(instance, dmVMath::Vector3(scale[0], scale[1], scale[2]));
+    if (fabsf(scale[0]) > 1e-6f && fabsf(scale[1]) > 1e-6f && fabsf(scale[2]) > 1e-6f) {
+        dmGameObject::SetRotation(instance, QuatFromBasis(axis[0] / scale[0], axis[1] / scale[1], axis[2] / scale[2]));
+    }
+}
+
+static int gizmo_ManipulateInstance(lua_State* L)
+{
+    int top = lua_gettop(L);
+    if (top < 5) {
+        return luaL_error(L, "manipulate_instance(url, view, projection, operation, mode, [snap], [local_bounds], [bounds_snap])");
+    }
+    ImGuizmo::BeginFrame();
+    dmGameObject::HInstance instance = dmScript::CheckGOInstance(L, 1);
+    ImGuizmo::OPERATION operation = (ImGuizmo::OPERATION)luaL_checkinteger(L, 4);
+    ImGuizmo::MODE mode = (ImGuizmo::MODE)luaL_checkinteger(L, 5);
+
+    float view_storage[16];
+    float projection_storage[16];
+    float model_storage[16];
+    const float* view_matrix = CameraMatrix(L, 2, view_storage);
+    const float* projection_matrix = CameraMatrix(L, 3, projection_storage);
+
+    dmVMath::Matrix4 world = GetInstanceWorldMatrix(instance);
+    float* model_matrix = Matrix4Floats(&world, model_storage);
+
+    ManipulateOptions options;
+    ReadManipulateOptions(L, 6, &options);
+
+    bool manipulated = ImGuizmo::Manipulate(
+        view_matrix,
+        projection_matrix,
+        operation,
+        mode,
+        model_matrix,
+        NULL,
+        options.snap,
+        options.local_bounds,
+        options.bounds_snap
+    );
+
+    if (manipulated) {
+        Matrix4Store(model_matrix, &world);
+        SetInstanceWorldMatrix(instance, world);
+    }
+    lua_pushboolean(L, manipulated);
+    return 1;
+}
+
+static int gizmo_ManipulateMany(lua_State* L)
+{
+    int top = lua_gettop(L);
+    if (top < 6) {
+        return luaL_error(L, "manipulate_many(view, projection, operation, mode, matrices, pivot, [active_index], [snap])");
+    }
+    ImGuizmo::BeginFrame();
+    ImGuizmo::OPERATION operation = (ImGuizmo::OPERATION)luaL_checkinteger(L, 3);
+    ImGuizmo::MODE mode = (ImGuizmo::MODE)luaL_checkinteger(L, 4);
+    luaL_checktype(L, 5, LUA_TTABLE);
+    ImGuizmo::PIVOT pivot = (ImGuizmo::PIVOT)luaL_checkinteger(L, 6);
+    int active_index = (int)luaL_optinteger(L, 7, 1) - 1;
 
     const float* snap = NULL;
     float snap_values[3];
-    if (top >= 6 && !lua_isnil(L, 6)) {
-        if (!ReadVector3OrNumber(L, 6, snap_values)) {
+    if (top >= 8 && !lua_isnil(L, 8)) {
+        if (!ReadVector3OrNumber(L, 8, snap_values)) {
             return luaL_error(L, "snap must be number or vmath.vector3");
         }
         snap = snap_values;
     }
 
-    const float* local_bounds = NULL;
-    float local_bounds_values[6];
-    if (top >= 7 && !lua_isnil(L, 7)) {
-        if (!ReadBounds(L, 7, local_bounds_values)) {
-            return luaL_error(L, "local_bounds must be table with 6 numbers");
-        }
-        local_bounds = local_bounds_values;
+    int count = (int)lua_objlen(L, 5);
+    if (count == 0) {
+        lua_pushboolean(L, 0);
+        return 1;
     }
 
-    const float* bounds_snap = NULL;
-    float bounds_snap_values[3];
-    if (top >= 8 && !lua_isnil(L, 8)) {
-        if (!ReadVector3OrNumber(L, 8, bounds_snap_values)) {
-            return luaL_error(L, "bounds_snap must be number or vmath.vector3");
+    float* matrices = (float*)ImGuizmo::ScratchAlloc((size_t)count * 16 * sizeof(float));
+    for (int i = 0; i < count; ++i) {
+        lua_rawgeti(L, 5, i + 1);
+        const dmVMath::Matrix4* m = dmScript::CheckMatrix4(L, -1);
+        float* out = &matrices[(size_t)i * 16];
+        if (g_Matrix4ZeroCopy) {
+            memcpy(out, m, 16 * sizeof(float));
+        } else {
+            Matrix4ToFloatArray(*m, out);
         }
-        bounds_snap = bounds_snap_values;
+        lua_pop(L, 1);
     }
 
-    bool manipulated = ImGuizmo::Manipulate(
+    float view_storage[16];
+    float projection_storage[16];
+    const float* view_matrix = CameraMatrix(L, 1, view_storage);
+    const float* projection_matrix = CameraMatrix(L, 2, projection_storage);
+
+    bool* changed = (bool*)ImGuizmo::ScratchAlloc((size_t)count * sizeof(bool));
+    bool manipulated = ImGuizmo::ManipulateMany(
         view_matrix,
         projection_matrix,
         operation,
         mode,
-        model_matrix,
-        delta_matrix,
-        snap,
-        local_bounds,
-        bounds_snap
+        matrices,
+        count,
+        pivot,
+        active_index,
+        changed,
+        snap
     );
 
-    FloatArrayToMatrix4(model_matrix, gizmo_matrix);
-
     lua_pushboolean(L, manipulated);
-    if (manipulated) {
-        dmVMath::Matrix4 delta;
-        FloatArrayToMatrix4(delta_matrix, &delta);
-        dmScript::PushMatrix4(L, delta);
-        return 2;
+    if (!manipulated) {
+        return 1;
     }
-    return 1;
+
+    // write back the modified matrices and list their indices
+    lua_newtable(L);
+    int changed_count = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!changed[i]) {
+            continue;
+        }
+        lua_rawgeti(L, 5, i + 1);
+        dmVMath::Matrix4* m = dmScript::CheckMatrix4(L, -1);
+        const float* in = &matrices[(size_t)i * 16];
+        if (g_Matrix4ZeroCopy) {
+            memcpy((float*)m, in, 16 * sizeof(float));
+        } else {
+            FloatArrayToMatrix4(in, m);
+        }
+        lua_pop(L, 1);
+        lua_pushinteger(L, i + 1);
+        lua_rawseti(L, -2, ++changed_count);
+    }
+    return 2;
 }
 
 static int gizmo_DecomposeMatrix(lua_State* L)
 {
     DM_LUA_STACK_CHECK(L, 3);
-    dmVMath::Matrix4 matrix = *dmScript::CheckMatrix4(L, 1);
-    float m[16];
-    Matrix4ToFloatArray(matrix, m);
+    float storage[16];
+    const float* m = Matrix4Floats(dmScript::CheckMatrix4(L, 1), storage);
 
     float translation[3];
     float rotation[3];
@@ -479,21 +835,76 @@ static int gizmo_RecomposeMatrix(lua_State* L)
     return 1;
 }
 
+static int gizmo_DecomposeMatrixInto(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    float storage[16];
+    const float* m = Matrix4Floats(dmScript::CheckMatrix4(L, 1), storage);
+    dmVMath::Vector3* out_translation = dmScript::CheckVector3(L, 2);
+    dmVMath::Vector3* out_rotation = dmScript::CheckVector3(L, 3);
+    dmVMath::Vector3* out_scale = dmScript::CheckVector3(L, 4);
+
+    float translation[3];
+    float rotation[3];
+    float scale[3];
+
+    ImGuizmo::DecomposeMatrixToComponents(m, translation, rotation, scale);
+
+    *out_translation = dmVMath::Vector3(translation[0], translation[1], translation[2]);
+    *out_rotation = dmVMath::Vector3(rotation[0], rotation[1], rotation[2]);
+    *out_scale = dmVMath::Vector3(scale[0], scale[1], scale[2]);
+    return 0;
+}
+
+static int gizmo_RecomposeMatrixInto(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    float translation[3];
+    float rotation[3];
+    float scale[3];
+
+    if (!ReadVector3(L, 1, translation)) {
+        return DM_LUA_ERROR("translation must be vmath.vector3");
+    }
+    if (!ReadVector3(L, 2, rotation)) {
+        return DM_LUA_ERROR("rotation must be vmath.vector3");
+    }
+    if (!ReadVector3(L, 3, scale)) {
+        return DM_LUA_ERROR("scale must be vmath.vector3");
+    }
+    dmVMath::Matrix4* out_matrix = dmScript::CheckMatrix4(L, 4);
+
+    float storage[16];
+    float* m = Matrix4Target(out_matrix, storage);
+    ImGuizmo::RecomposeMatrixFromComponents(translation, rotation, scale, m);
+    Matrix4Store(m, out_matrix);
+    return 0;
+}
+
+static int gizmo_SetCamera(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    float view_storage[16];
+    float projection_storage[16];
+    const float* view_matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 1), view_storage);
+    const float* projection_matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 2), projection_storage);
+    ImGuizmo::SetCamera(view_matrix, projection_matrix);
+    return 0;
+}
+
 static int gizmo_DrawGrid(lua_State* L)
 {
     DM_LUA_STACK_CHECK(L, 0);
     ImGuizmo::BeginFrame();
-    dmVMath::Matrix4 view = *dmScript::CheckMatrix4(L, 1);
-    dmVMath::Matrix4 projection = *dmScript::CheckMatrix4(L, 2);
-    dmVMath::Matrix4 grid_matrix = *dmScript::CheckMatrix4(L, 3);
+    const dmVMath::Matrix4* grid_matrix = dmScript::CheckMatrix4(L, 3);
     float grid_size = (float)luaL_checknumber(L, 4);
 
-    float view_matrix[16];
-    float projection_matrix[16];
-    float matrix[16];
-    Matrix4ToFloatArray(view, view_matrix);
-    Matrix4ToFloatArray(projection, projection_matrix);
-    Matrix4ToFloatArray(grid_matrix, matrix);
+    float view_storage[16];
+    float projection_storage[16];
+    float matrix_storage[16];
+    const float* view_matrix = CameraMatrix(L, 1, view_storage);
+    const float* projection_matrix = CameraMatrix(L, 2, projection_storage);
+    const float* matrix = Matrix4Floats(grid_matrix, matrix_storage);
 
     ImGuizmo::DrawGrid(view_matrix, projection_matrix, matrix, grid_size);
     return 0;
@@ -545,11 +956,28 @@ static int gizmo_DrawCubes(lua_State* L)
 {
     DM_LUA_STACK_CHECK(L, 0);
     ImGuizmo::BeginFrame();
-    dmVMath::Matrix4 view = *dmScript::CheckMatrix4(L, 1);
-    dmVMath::Matrix4 projection = *dmScript::CheckMatrix4(L, 2);
+
+    float view_storage[16];
+    float projection_storage[16];
+    const float* view_matrix = CameraMatrix(L, 1, view_storage);
+    const float* projection_matrix = CameraMatrix(L, 2, projection_storage);
+
+    if (dmScript::IsBuffer(L, 3)) {
+        const char* stream_name = luaL_optstring(L, 4, "matrix");
+        const float* matrices = NULL;
+        int count = 0;
+        int stride = 0;
+        if (!GetBufferFloats(L, 3, stream_name, 16, &matrices, &count, &stride)) {
+            return DM_LUA_ERROR("buffer stream '%s' must be float32 with 16 components", stream_name);
+        }
+        if (count > 0) {
+            ImGuizmo::DrawCubes(view_matrix, projection_matrix, matrices, count, stride);
+        }
+        return 0;
+    }
 
     if (!lua_istable(L, 3)) {
-        return DM_LUA_ERROR("matrices must be a table of vmath.matrix4");
+        return DM_LUA_ERROR("matrices must be a table of vmath.matrix4 or a buffer");
     }
 
     int count = (int)lua_objlen(L, 3);
@@ -557,22 +985,21 @@ static int gizmo_DrawCubes(lua_State* L)
         return 0;
     }
 
-    std::vector<float> matrices;
-    matrices.resize((size_t)count * 16);
+    float* matrices = (float*)ImGuizmo::ScratchAlloc((size_t)count * 16 * sizeof(float));
 
     for (int i = 0; i < count; ++i) {
         lua_rawgeti(L, 3, i + 1);
-        dmVMath::Matrix4* m = dmScript::CheckMatrix4(L, -1);
-        Matrix4ToFloatArray(*m, &matrices[(size_t)i * 16]);
+        const dmVMath::Matrix4* m = dmScript::CheckMatrix4(L, -1);
+        float* out = &matrices[(size_t)i * 16];
+        if (g_Matrix4ZeroCopy) {
+            memcpy(out, m, 16 * sizeof(float));
+        } else {
+            Matrix4ToFloatArray(*m, out);
+        }
         lua_pop(L, 1);
     }
 
-    float view_matrix[16];
-    float projection_matrix[16];
-    Matrix4ToFloatArray(view, view_matrix);
-    Matrix4ToFloatArray(projection, projection_matrix);
-
-    ImGuizmo::DrawCubes(view_matrix, projection_matrix, matrices.data(), count);
+    ImGuizmo::DrawCubes(view_matrix, projection_matrix, matrices, count);
     return 0;
 }
 
@@ -586,11 +1013,10 @@ static int gizmo_ViewManipulate(lua_State* L)
     ImGuizmo::BeginFrame();
 
     dmVMath::Matrix4* view = dmScript::CheckMatrix4(L, 1);
-    float view_matrix[16];
-    Matrix4ToFloatArray(*view, view_matrix);
+    float view_storage[16];
+    float* view_matrix = Matrix4Floats(view, view_storage);
 
-    if (dmScript::IsMatrix4(L, 2)) {
-        dmVMath::Matrix4 projection = *dmScript::CheckMatrix4(L, 2);
+    if (dmScript::IsMatrix4(L, 2) || (lua_isnil(L, 2) && top >= 9)) {
         ImGuizmo::OPERATION operation = (ImGuizmo::OPERATION)luaL_checkinteger(L, 3);
         ImGuizmo::MODE mode = (ImGuizmo::MODE)luaL_checkinteger(L, 4);
         dmVMath::Matrix4* matrix = dmScript::CheckMatrix4(L, 5);
@@ -606,10 +1032,10 @@ static int gizmo_ViewManipulate(lua_State* L)
         }
         ImU32 background_color = (ImU32)luaL_checkinteger(L, 9);
 
-        float projection_matrix[16];
-        float model_matrix[16];
-        Matrix4ToFloatArray(projection, projection_matrix);
-        Matrix4ToFloatArray(*matrix, model_matrix);
+        float projection_storage[16];
+        float model_storage[16];
+        const float* projection_matrix = CameraMatrix(L, 2, projection_storage);
+        float* model_matrix = Matrix4Floats(matrix, model_storage);
 
         ImGuizmo::ViewManipulate(
             view_matrix,
@@ -623,7 +1049,7 @@ static int gizmo_ViewManipulate(lua_State* L)
             background_color
         );
 
-        FloatArrayToMatrix4(model_matrix, matrix);
+        Matrix4Store(model_matrix, matrix);
     } else {
         float length = (float)luaL_checknumber(L, 2);
         float position_vec[3];
@@ -645,10 +1071,336 @@ static int gizmo_ViewManipulate(lua_State* L)
         );
     }
 
-    FloatArrayToMatrix4(view_matrix, view);
+    Matrix4Store(view_matrix, view);
+    return 0;
+}
+
+static int gizmo_PickingAddAABB(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 1), matrix_storage);
+    float min[3];
+    float max[3];
+    if (!ReadVector3(L, 2, min) || !ReadVector3(L, 3, max)) {
+        return DM_LUA_ERROR("min and max must be vmath.vector3");
+    }
+    lua_pushinteger(L, Picking::AddAABB(matrix, min, max));
+    return 1;
+}
+
+static int gizmo_PickingAddSphere(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 1), matrix_storage);
+    float center[3];
+    if (!ReadVector3(L, 2, center)) {
+        return DM_LUA_ERROR("center must be vmath.vector3");
+    }
+    float radius = (float)luaL_checknumber(L, 3);
+    lua_pushinteger(L, Picking::AddSphere(matrix, center, radius));
+    return 1;
+}
+
+static int gizmo_PickingSetMatrix(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = (int)luaL_checkinteger(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 2), matrix_storage);
+    lua_pushboolean(L, Picking::SetMatrix(handle, matrix));
+    return 1;
+}
+
+static int gizmo_PickingRemove(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, Picking::Remove((int)luaL_checkinteger(L, 1)));
+    return 1;
+}
+
+static int gizmo_PickingClear(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    Picking::Clear();
+    return 0;
+}
+
+static int gizmo_PickingCount(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushinteger(L, Picking::GetCount());
+    return 1;
+}
+
+static float g_VertexSnapRadius = 0.0f;
+static bool g_SurfaceSnap = false;
+static bool g_SurfaceAlign = false;
+
+// vertices near the cursor win over the surface under it
+static bool SnapTranslation(const ImGuizmo::TranslationSnapQuery* query, ImGuizmo::TranslationSnapResult* result, void* /*user_data*/)
+{
+    if (g_VertexSnapRadius > 0.0f) {
+        float rect[4] = { query->rectPosition.x, query->rectPosition.y, query->rectSize.x, query->rectSize.y };
+        if (VertexSnap::FindNearest(query->viewProjection, rect, query->mousePos.x, query->mousePos.y, g_VertexSnapRadius, result->position, NULL)) {
+            return true;
+        }
+    }
+    if (g_SurfaceSnap) {
+        float distance = 0.0f;
+        if (Surface::Raycast(query->rayOrigin, query->rayDirection, FLT_MAX, &distance, result->surfaceNormal)) {
+            for (int i = 0; i < 3; ++i) {
+                result->position[i] = query->rayOrigin[i] + query->rayDirection[i] * distance;
+            }
+            result->alignToSurface = g_SurfaceAlign;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void UpdateSnapCallback()
+{
+    ImGuizmo::SetTranslationSnapCallback(g_VertexSnapRadius > 0.0f || g_SurfaceSnap ? SnapTranslation : NULL);
+}
+
+static int gizmo_SetVertexSnap(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    g_VertexSnapRadius = (float)luaL_optnumber(L, 1, 0.0);
+    UpdateSnapCallback();
+    return 0;
+}
+
+static int gizmo_VertexSnapAddMesh(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 1), matrix_storage);
+    const float* positions = NULL;
+    int count = 0;
+    int stride = 3;
+    char error[128];
+    if (!ReadPositions(L, 2, luaL_optstring(L, 3, "position"), &positions, &count, &stride, error, sizeof(error))) {
+        return DM_LUA_ERROR("%s", error);
+    }
+    lua_pushinteger(L, VertexSnap::AddMesh(matrix, positions, count, stride));
+    return 1;
+}
+
+static int gizmo_VertexSnapSetMatrix(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = (int)luaL_checkinteger(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 2), matrix_storage);
+    lua_pushboolean(L, VertexSnap::SetMatrix(handle, matrix));
+    return 1;
+}
+
+static int gizmo_VertexSnapSetEnabled(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = (int)luaL_checkinteger(L, 1);
+    lua_pushboolean(L, VertexSnap::SetEnabled(handle, lua_toboolean(L, 2)));
+    return 1;
+}
+
+static int gizmo_VertexSnapRemove(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, VertexSnap::Remove((int)luaL_checkinteger(L, 1)));
+    return 1;
+}
+
+static int gizmo_VertexSnapClear(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    VertexSnap::Clear();
+    return 0;
+}
+
+static int gizmo_SetSurfaceSnap(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    g_SurfaceSnap = lua_toboolean(L, 1) != 0;
+    g_SurfaceAlign = lua_toboolean(L, 2) != 0;
+    UpdateSnapCallback();
+    return 0;
+}
+
+static int gizmo_SurfaceAddMesh(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 1), matrix_storage);
+    const float* positions = NULL;
+    int count = 0;
+    int stride = 3;
+    char error[128];
+    if (!ReadPositions(L, 2, luaL_optstring(L, 4, "position"), &positions, &count, &stride, error, sizeof(error))) {
+        return DM_LUA_ERROR("%s", error);
+    }
+
+    // 1-based indices like Lua tables, a triangle list when omitted
+    int* indices = NULL;
+    int index_count = 0;
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        index_count = (int)lua_objlen(L, 3);
+        indices = (int*)ImGuizmo::ScratchAlloc((size_t)index_count * sizeof(int));
+        for (int i = 0; i < index_count; ++i) {
+            lua_rawgeti(L, 3, i + 1);
+            if (!lua_isnumber(L, -1)) {
+                lua_pop(L, 1);
+                return DM_LUA_ERROR("indices[%d] must be a number", i + 1);
+            }
+            indices[i] = (int)lua_tointeger(L, -1) - 1;
+            lua_pop(L, 1);
+        }
+    }
+    lua_pushinteger(L, Surface::AddMesh(matrix, positions, count, stride, indices, index_count));
+    return 1;
+}
+
+static int gizmo_SurfaceUpdateMesh(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = (int)luaL_checkinteger(L, 1);
+    const float* positions = NULL;
+    int count = 0;
+    int stride = 3;
+    char error[128];
+    if (!ReadPositions(L, 2, luaL_optstring(L, 3, "position"), &positions, &count, &stride, error, sizeof(error))) {
+        return DM_LUA_ERROR("%s", error);
+    }
+    lua_pushboolean(L, Surface::UpdateMesh(handle, positions, count, stride));
+    return 1;
+}
+
+static int gizmo_SurfaceSetMatrix(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = (int)luaL_checkinteger(L, 1);
+    float matrix_storage[16];
+    const float* matrix = Matrix4Floats(dmScript::CheckMatrix4(L, 2), matrix_storage);
+    lua_pushboolean(L, Surface::SetMatrix(handle, matrix));
+    return 1;
+}
+
+static int gizmo_SurfaceSetEnabled(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = (int)luaL_checkinteger(L, 1);
+    lua_pushboolean(L, Surface::SetEnabled(handle, lua_toboolean(L, 2)));
+    return 1;
+}
+
+static int gizmo_SurfaceRemove(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, Surface::Remove((int)luaL_checkinteger(L, 1)));
+    return 1;
+}
+
+static int gizmo_SurfaceClear(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    Surface::Clear();
     return 0;
 }
 
+static int gizmo_SurfaceRaycast(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 3);
+    if (!ImGuizmo::HasCamera()) {
+        return DM_LUA_ERROR("surface_raycast requires set_camera");
+    }
+    ImVec2 screen_pos = ImGui::GetIO().MousePos;
+    if (!lua_isnoneornil(L, 1)) {
+        screen_pos = ImVec2((float)luaL_checknumber(L, 1), (float)luaL_checknumber(L, 2));
+    }
+
+    float ray_origin[3];
+    float ray_direction[3];
+    ImGuizmo::ComputeRay(screen_pos, ray_origin, ray_direction);
+    float distance = 0.0f;
+    float normal[3];
+    int handle = Surface::Raycast(ray_origin, ray_direction, FLT_MAX, &distance, normal);
+    if (handle == 0) {
+        lua_pushnil(L);
+        lua_pushnil(L);
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, handle);
+        dmScript::PushVector3(L, dmVMath::Vector3(ray_origin[0] + ray_direction[0] * distance,
+            ray_origin[1] + ray_direction[1] * distance, ray_origin[2] + ray_direction[2] * distance));
+        dmScript::PushVector3(L, dmVMath::Vector3(normal[0], normal[1], normal[2]));
+    }
+    return 3;
+}
+
+static int gizmo_SelectInRect(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 2);
+    if (!ImGuizmo::HasCamera()) {
+        return DM_LUA_ERROR("select_in_rect requires set_camera");
+    }
+    ImVec2 corner_a((float)luaL_checknumber(L, 1), (float)luaL_checknumber(L, 2));
+    ImVec2 corner_b((float)luaL_checknumber(L, 3), (float)luaL_checknumber(L, 4));
+    float planes[6 * 4];
+    ImGuizmo::ComputeRectFrustum(corner_a, corner_b, planes);
+    const int* handles = NULL;
+    int count = Picking::SelectInPlanes(planes, 6, &handles);
+
+    // fill the caller's table when given, so a drag can reuse one table every frame
+    int previous_count = 0;
+    if (lua_istable(L, 5)) {
+        previous_count = (int)lua_objlen(L, 5);
+        lua_pushvalue(L, 5);
+    } else {
+        lua_createtable(L, count, 0);
+    }
+    for (int i = 0; i < count; ++i) {
+        lua_pushinteger(L, handles[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
+    for (int i = count; i < previous_count; ++i) {
+        lua_pushnil(L);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_pushinteger(L, count);
+    return 2;
+}
+
+static int gizmo_Pick(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 2);
+    if (!ImGuizmo::HasCamera()) {
+        return DM_LUA_ERROR("pick requires set_camera");
+    }
+    ImVec2 screen_pos = ImGui::GetIO().MousePos;
+    if (!lua_isnoneornil(L, 1)) {
+        screen_pos = ImVec2((float)luaL_checknumber(L, 1), (float)luaL_checknumber(L, 2));
+    }
+    float max_distance = (float)luaL_optnumber(L, 3, FLT_MAX);
+
+    float ray_origin[3];
+    float ray_direction[3];
+    ImGuizmo::ComputeRay(screen_pos, ray_origin, ray_direction);
+    float distance = 0.0f;
+    int handle = Picking::Raycast(ray_origin, ray_direction, max_distance, &distance);
+    if (handle == 0) {
+        lua_pushnil(L);
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, handle);
+        lua_pushnumber(L, distance);
+    }
+    return 2;
+}
+
 static int gizmo_GetStyle(lua_State* L)
 {
     DM_LUA_STACK_CHECK(L, 1);
@@ -688,6 +1440,10 @@ static int gizmo_GetStyle(lua_State* L)
     lua_pushnumber(L, style.CenterCircleSize);
     lua_rawset(L, -3);
 
+    lua_pushliteral(L, "CircleTessellationMaxError");
+    lua_pushnumber(L, style.CircleTessellationMaxError);
+    lua_rawset(L, -3);
+
     lua_pushliteral(L, "Colors");
     lua_newtable(L);
     for (int i = 0; i < ImGuizmo::COLOR::COUNT; ++i) {
@@ -700,16 +1456,10 @@ static int gizmo_GetStyle(lua_State* L)
     return 1;
 }
 
-static int gizmo_SetStyle(lua_State* L)
+// applies the fields present in the style table at index to style
+static void ReadStyle(lua_State* L, int index, ImGuizmo::Style& style)
 {
-    DM_LUA_STACK_CHECK(L, 0);
-    if (lua_isnil(L, 1)) {
-        return 0;
-    }
-    luaL_checktype(L, 1, LUA_TTABLE);
-    ImGuizmo::Style& style = ImGuizmo::GetStyle();
-
-    lua_pushvalue(L, 1);
+    lua_pushvalue(L, index);
     lua_pushnil(L);
     while (lua_next(L, -2)) {
         const char* attr = lua_tostring(L, -2);
@@ -733,6 +1483,8 @@ static int gizmo_SetStyle(lua_State* L)
             style.HatchedAxisLineThickness = (float)luaL_checknumber(L, -1);
         } else if (strcmp(attr, "CenterCircleSize") == 0) {
             style.CenterCircleSize = (float)luaL_checknumber(L, -1);
+        } else if (strcmp(attr, "CircleTessellationMaxError") == 0) {
+            style.CircleTessellationMaxError = (float)luaL_checknumber(L, -1);
         } else if (strcmp(attr, "Colors") == 0) {
             if (lua_istable(L, -1)) {
                 lua_pushnil(L);
@@ -751,6 +1503,51 @@ static int gizmo_SetStyle(lua_State* L)
         lua_pop(L, 1);
     }
     lua_pop(L, 1);
+}
+
+static int gizmo_SetStyle(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    if (lua_isnil(L, 1)) {
+        return 0;
+    }
+    luaL_checktype(L, 1, LUA_TTABLE);
+    ReadStyle(L, 1, ImGuizmo::GetStyle());
+    return 0;
+}
+
+static int gizmo_CreateStyle(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    const char* name = luaL_checkstring(L, 1);
+    ImGuizmo::Style style = ImGuizmo::GetStyle();
+    if (!lua_isnoneornil(L, 2)) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+        ReadStyle(L, 2, style);
+    }
+    lua_pushinteger(L, ImGuizmo::CreateStyle(name, style));
+    return 1;
+}
+
+static int gizmo_FindStyle(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    int handle = ImGuizmo::FindStyle(luaL_checkstring(L, 1));
+    if (handle < 0) {
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, handle);
+    }
+    return 1;
+}
+
+static int gizmo_UseStyle(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    int handle = (int)luaL_checkinteger(L, 1);
+    if (!ImGuizmo::UseStyle(handle)) {
+        return DM_LUA_ERROR("unknown style handle %d", handle);
+    }
     return 0;
 }
 
@@ -840,6 +1637,13 @@ static int gizmo_SetDrawlist(lua_State* L)
     return 0;
 }
 
+static int gizmo_GetScratchHighWater(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushinteger(L, (lua_Integer)ImGuizmo::GetScratchHighWaterMark());
+    return 1;
+}
+
 static int gizmo_SetDrawlistForeground(lua_State* L)
 {
     DM_LUA_STACK_CHECK(L, 0);
@@ -861,6 +1665,7 @@ static const luaL_Reg Module_methods[] = {
     {"is_over", gizmo_IsOver},
     {"is_over_operation", gizmo_IsOverOperation},
     {"is_over_position", gizmo_IsOverPosition},
+    {"is_over_positions", gizmo_IsOverPositions},
     {"is_using", gizmo_IsUsing},
     {"is_using_view_manipulate", gizmo_IsUsingViewManipulate},
     {"is_using_any", gizmo_IsUsingAny},
@@ -869,17 +1674,48 @@ static const luaL_Reg Module_methods[] = {
     {"set_axis_limit", gizmo_SetAxisLimit},
     {"set_axis_mask", gizmo_SetAxisMask},
     {"set_plane_limit", gizmo_SetPlaneLimit},
+    {"set_camera", gizmo_SetCamera},
     {"manipulate", gizmo_Manipulate},
+    {"manipulate_many", gizmo_ManipulateMany},
+    {"manipulate_instance", gizmo_ManipulateInstance},
     {"decompose_matrix", gizmo_DecomposeMatrix},
     {"recompose_matrix", gizmo_RecomposeMatrix},
+    {"decompose_matrix_into", gizmo_DecomposeMatrixInto},
+    {"recompose_matrix_into", gizmo_RecomposeMatrixInto},
     {"draw_grid", gizmo_DrawGrid},
     {"set_grid_colors", gizmo_SetGridColors},
     {"draw_cubes", gizmo_DrawCubes},
     {"view_manipulate", gizmo_ViewManipulate},
+    {"picking_add_aabb", gizmo_PickingAddAABB},
+    {"picking_add_sphere", gizmo_PickingAddSphere},
+    {"picking_set_matrix", gizmo_PickingSetMatrix},
+    {"picking_remove", gizmo_PickingRemove},
+    {"picking_clear", gizmo_PickingClear},
+    {"picking_count", gizmo_PickingCount},
+    {"pick", gizmo_Pick},
+    {"select_in_rect", gizmo_SelectInRect},
+    {"set_vertex_snap", gizmo_SetVertexSnap},
+    {"vertex_snap_add_mesh", gizmo_VertexSnapAddMesh},
+    {"vertex_snap_set_matrix", gizmo_VertexSnapSetMatrix},
+    {"vertex_snap_set_enabled", gizmo_VertexSnapSetEnabled},
+    {"vertex_snap_remove", gizmo_VertexSnapRemove},
+    {"vertex_snap_clear", gizmo_VertexSnapClear},
+    {"set_surface_snap", gizmo_SetSurfaceSnap},
+    {"surface_add_mesh", gizmo_SurfaceAddMesh},
+    {"surface_update_mesh", gizmo_SurfaceUpdateMesh},
+    {"surface_set_matrix", gizmo_SurfaceSetMatrix},
+    {"surface_set_enabled", gizmo_SurfaceSetEnabled},
+    {"surface_remove", gizmo_SurfaceRemove},
+    {"surface_clear", gizmo_SurfaceClear},
+    {"surface_raycast", gizmo_SurfaceRaycast},
     {"get_style", gizmo_GetStyle},
     {"set_style", gizmo_SetStyle},
+    {"create_style", gizmo_CreateStyle},
+    {"find_style", gizmo_FindStyle},
+    {"use_style", gizmo_UseStyle},
     {"get_style_color", gizmo_GetStyleColor},
     {"set_style_color", gizmo_SetStyleColor},
+    {"get_scratch_high_water", gizmo_GetScratchHighWater},
     {"quat_from_euler", gizmo_QuatFromEuler},
     {"quat_from_basis", gizmo_QuatFromBasis},
     {"quat_look_at", gizmo_QuatLookAt},
@@ -901,6 +1737,7 @@ static void lua_setfieldstringint(lua_State* L, const char* key, uint32_t value)
 static void LuaInit(lua_State* L)
 {
     int top = lua_gettop(L);
+    VerifyMatrix4Layout();
     luaL_register(L, MODULE_NAME, Module_methods);
 
     lua_setfieldstringint(L, "MODE_WORLD", ImGuizmo::MODE::WORLD);
@@ -925,6 +1762,10 @@ static void LuaInit(lua_State* L)
     lua_setfieldstringint(L, "OPERATION_SCALE_YU", ImGuizmo::OPERATION::SCALE_YU);
     lua_setfieldstringint(L, "OPERATION_SCALE_ZU", ImGuizmo::OPERATION::SCALE_ZU);
 
+    lua_setfieldstringint(L, "PIVOT_CENTROID", ImGuizmo::PIVOT::CENTROID);
+    lua_setfieldstringint(L, "PIVOT_BOUNDS_CENTER", ImGuizmo::PIVOT::BOUNDS_CENTER);
+    lua_setfieldstringint(L, "PIVOT_ACTIVE", ImGuizmo::PIVOT::ACTIVE);
+
     lua_setfieldstringint(L, "COLOR_DIRECTION_X", ImGuizmo::COLOR::DIRECTION_X);
     lua_setfieldstringint(L, "COLOR_DIRECTION_Y", ImGuizmo::COLOR::DIRECTION_Y);
     lua_setfieldstringint(L, "COLOR_DIRECTION_Z", ImGuizmo::COLOR::DIRECTION_Z);
@@ -0,0 +1,132 @@
+// C API for native extensions, see imgui_gizmo_api.h
+// Thin wrappers over ImGuizmo: the state is the same as the one the Lua module works on.
+
+#include "imgui.h"
+#include "imguizmo.h"
+#include "imgui_gizmo_api.h"
+
+int imgui_gizmo_set_context(void* imgui_context)
+{
+    ImGuiContext* ctx = imgui_context ? (ImGuiContext*)imgui_context : ImGui::GetCurrentContext();
+    if (ctx == NULL) {
+        return 0;
+    }
+    ImGuizmo::SetImGuiContext(ctx);
+    return 1;
+}
+
+void imgui_gizmo_set_rect(float x, float y, float width, float height)
+{
+    ImGuizmo::SetRect(x, y, width, height);
+}
+
+void imgui_gizmo_set_orthographic(int is_orthographic)
+{
+    ImGuizmo::SetOrthographic(is_orthographic != 0);
+}
+
+void imgui_gizmo_set_drawlist(void* draw_list)
+{
+    ImGuizmo::SetDrawlist((ImDrawList*)draw_list);
+}
+
+void imgui_gizmo_set_drawlist_foreground(void)
+{
+    ImGuizmo::SetDrawlist(ImGui::GetForegroundDrawList());
+}
+
+void imgui_gizmo_set_drawlist_background(void)
+{
+    ImGuizmo::SetDrawlist(ImGui::GetBackgroundDrawList());
+}
+
+void imgui_gizmo_set_camera(const float* view, const float* projection)
+{
+    ImGuizmo::SetCamera(view, projection);
+}
+
+int imgui_gizmo_has_camera(void)
+{
+    return ImGuizmo::HasCamera();
+}
+
+int imgui_gizmo_manipulate(const float* view, const float* projection, int operation, int mode, float* matrix,
+    float* delta_matrix, const float* snap, const float* local_bounds, const float* bounds_snap)
+{
+    ImGuizmo::BeginFrame();
+    return ImGuizmo::Manipulate(view, projection, (ImGuizmo::OPERATION)operation, (ImGuizmo::MODE)mode, matrix,
+        delta_matrix, snap, local_bounds, bounds_snap);
+}
+
+int imgui_gizmo_manipulate_many(const float* view, const float* projection, int operation, int mode, float* matrices,
+    int matrix_count, int pivot, int active_index, uint8_t* changed, const float* snap)
+{
+    ImGuizmo::BeginFrame();
+    bool* changed_flags = NULL;
+    if (changed && matrix_count > 0) {
+        changed_flags = (bool*)ImGuizmo::ScratchAlloc((size_t)matrix_count * sizeof(bool));
+    }
+    bool manipulated = ImGuizmo::ManipulateMany(view, projection, (ImGuizmo::OPERATION)operation, (ImGuizmo::MODE)mode,
+        matrices, matrix_count, (ImGuizmo::PIVOT)pivot, active_index, changed_flags, snap);
+    for (int i = 0; changed_flags && i < matrix_count; ++i) {
+        changed[i] = changed_flags[i] ? 1 : 0;
+    }
+    return manipulated;
+}
+
+void imgui_gizmo_view_manipulate(float* view, float length, float x, float y, float width, float height, uint32_t background_color)
+{
+    ImGuizmo::BeginFrame();
+    ImGuizmo::ViewManipulate(view, length, ImVec2(x, y), ImVec2(width, height), (ImU32)background_color);
+}
+
+void imgui_gizmo_draw_grid(const float* view, const float* projection, const float* matrix, float grid_size)
+{
+    ImGuizmo::BeginFrame();
+    ImGuizmo::DrawGrid(view, projection, matrix, grid_size);
+}
+
+void imgui_gizmo_draw_cubes(const float* view, const float* projection, const float* matrices, int matrix_count, int matrix_stride)
+{
+    ImGuizmo::BeginFrame();
+    if (matrix_count > 0) {
+        ImGuizmo::DrawCubes(view, projection, matrices, matrix_count, matrix_stride);
+    }
+}
+
+int imgui_gizmo_is_over(void)
+{
+    return ImGuizmo::IsOver();
+}
+
+int imgui_gizmo_is_over_operation(int operation)
+{
+    return ImGuizmo::IsOver((ImGuizmo::OPERATION)operation);
+}
+
+int imgui_gizmo_is_over_position(const float* position, float pixel_radius)
+{
+    float p[3] = { position[0], position[1], position[2] };
+    return ImGuizmo::IsOver(p, pixel_radius);
+}
+
+int imgui_gizmo_is_over_positions(const float* positions, int count, int position_stride, const float* pixel_radii,
+    int radius_stride, float pixel_radius, float* distance)
+{
+    return ImGuizmo::IsOverPositions(positions, count, position_stride, pixel_radii, radius_stride, pixel_radius, distance);
+}
+
+int imgui_gizmo_is_using(void)
+{
+    return ImGuizmo::IsUsing();
+}
+
+int imgui_gizmo_is_using_any(void)
+{
+    return ImGuizmo::IsUsingAny();
+}
+
+int imgui_gizmo_is_using_view_manipulate(void)
+{
+    return ImGuizmo::IsUsingViewManipulate();
+}
@@ -31,12 +31,27 @@
 #include "imgui_internal.h"
 #include "imguizmo.h"
 
-#if defined(_MSC_VER) || defined(__MINGW32__)
-#include <malloc.h>
+// SIMD backend for the matrix_t/vec_t hot paths, picked at compile time.
+// Define IMGUIZMO_DISABLE_SIMD to force the scalar (FPU_) reference implementation.
+// Define IMGUIZMO_SIMD_SELF_CHECK to run both paths and assert that they agree within IMGUIZMO_SIMD_SELF_CHECK_TOLERANCE.
+#if !defined(IMGUIZMO_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUIZMO_SIMD_SSE
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define IMGUIZMO_SIMD_AVX
+#include <immintrin.h>
 #endif
-#if !defined(_MSC_VER) && !defined(__MINGW64_VERSION_MAJOR)
-#define _malloca(x) alloca(x)
-#define _freea(x)
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (defined(__clang__) || defined(__GNUC__))
+#define IMGUIZMO_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+#if defined(IMGUIZMO_SIMD_SSE) || defined(IMGUIZMO_SIMD_NEON)
+#define IMGUIZMO_SIMD
+#endif
+#ifndef IMGUIZMO_SIMD_SELF_CHECK_TOLERANCE
+#define IMGUIZMO_SIMD_SELF_CHECK_TOLERANCE 1e-4f
 #endif
 
 // includes patches for multiview from
@@ -78,6 +93,9 @@ namespace IMGUIZMO_NAMESPACE
    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
    // utility and math
 
+   // max deviation of the basis Gram matrix from identity for a matrix to be inverted as rigid
+   static const float rigidTolerance = 1e-5f;
+
    void FPU_MatrixF_x_MatrixF(const float* a, const float* b, float* r)
    {
       r[0] = a[0] * b[0] + a[1] * b[4] + a[2] * b[8] + a[3] * b[12];
@@ -101,6 +119,457 @@ namespace IMGUIZMO_NAMESPACE
       r[15] = a[12] * b[3] + a[13] * b[7] + a[14] * b[11] + a[15] * b[15];
    }
 
+#if !defined(IMGUIZMO_SIMD) || defined(IMGUIZMO_SIMD_SELF_CHECK)
+   static void FPU_Vec4F_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      const float x = v[0], y = v[1], z = v[2], w = v[3];
+      r[0] = x * m[0] + y * m[4] + z * m[8] + w * m[12];
+      r[1] = x * m[1] + y * m[5] + z * m[9] + w * m[13];
+      r[2] = x * m[2] + y * m[6] + z * m[10] + w * m[14];
+      r[3] = x * m[3] + y * m[7] + z * m[11] + w * m[15];
+   }
+
+   static void FPU_PointF_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      const float x = v[0], y = v[1], z = v[2];
+      r[0] = x * m[0] + y * m[4] + z * m[8] + m[12];
+      r[1] = x * m[1] + y * m[5] + z * m[9] + m[13];
+      r[2] = x * m[2] + y * m[6] + z * m[10] + m[14];
+      r[3] = x * m[3] + y * m[7] + z * m[11] + m[15];
+   }
+
+   static void FPU_VectorF_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      const float x = v[0], y = v[1], z = v[2];
+      r[0] = x * m[0] + y * m[4] + z * m[8];
+      r[1] = x * m[1] + y * m[5] + z * m[9];
+      r[2] = x * m[2] + y * m[6] + z * m[10];
+      r[3] = x * m[3] + y * m[7] + z * m[11];
+   }
+
+   static float FPU_InverseMatrixF(const float* srcMatrix, float* r)
+   {
+      // transpose matrix
+      float src[16];
+      for (int i = 0; i < 4; ++i)
+      {
+         src[i] = srcMatrix[i * 4];
+         src[i + 4] = srcMatrix[i * 4 + 1];
+         src[i + 8] = srcMatrix[i * 4 + 2];
+         src[i + 12] = srcMatrix[i * 4 + 3];
+      }
+
+      // calculate pairs for first 8 elements (cofactors)
+      float tmp[12]; // temp array for pairs
+      tmp[0] = src[10] * src[15];
+      tmp[1] = src[11] * src[14];
+      tmp[2] = src[9] * src[15];
+      tmp[3] = src[11] * src[13];
+      tmp[4] = src[9] * src[14];
+      tmp[5] = src[10] * src[13];
+      tmp[6] = src[8] * src[15];
+      tmp[7] = src[11] * src[12];
+      tmp[8] = src[8] * src[14];
+      tmp[9] = src[10] * src[12];
+      tmp[10] = src[8] * src[13];
+      tmp[11] = src[9] * src[12];
+
+      // calculate first 8 elements (cofactors)
+      r[0] = (tmp[0] * src[5] + tmp[3] * src[6] + tmp[4] * src[7]) - (tmp[1] * src[5] + tmp[2] * src[6] + tmp[5] * src[7]);
+      r[1] = (tmp[1] * src[4] + tmp[6] * src[6] + tmp[9] * src[7]) - (tmp[0] * src[4] + tmp[7] * src[6] + tmp[8] * src[7]);
+      r[2] = (tmp[2] * src[4] + tmp[7] * src[5] + tmp[10] * src[7]) - (tmp[3] * src[4] + tmp[6] * src[5] + tmp[11] * src[7]);
+      r[3] = (tmp[5] * src[4] + tmp[8] * src[5] + tmp[11] * src[6]) - (tmp[4] * src[4] + tmp[9] * src[5] + tmp[10] * src[6]);
+      r[4] = (tmp[1] * src[1] + tmp[2] * src[2] + tmp[5] * src[3]) - (tmp[0] * src[1] + tmp[3] * src[2] + tmp[4] * src[3]);
+      r[5] = (tmp[0] * src[0] + tmp[7] * src[2] + tmp[8] * src[3]) - (tmp[1] * src[0] + tmp[6] * src[2] + tmp[9] * src[3]);
+      r[6] = (tmp[3] * src[0] + tmp[6] * src[1] + tmp[11] * src[3]) - (tmp[2] * src[0] + tmp[7] * src[1] + tmp[10] * src[3]);
+      r[7] = (tmp[4] * src[0] + tmp[9] * src[1] + tmp[10] * src[2]) - (tmp[5] * src[0] + tmp[8] * src[1] + tmp[11] * src[2]);
+
+      // calculate pairs for second 8 elements (cofactors)
+      tmp[0] = src[2] * src[7];
+      tmp[1] = src[3] * src[6];
+      tmp[2] = src[1] * src[7];
+      tmp[3] = src[3] * src[5];
+      tmp[4] = src[1] * src[6];
+      tmp[5] = src[2] * src[5];
+      tmp[6] = src[0] * src[7];
+      tmp[7] = src[3] * src[4];
+      tmp[8] = src[0] * src[6];
+      tmp[9] = src[2] * src[4];
+      tmp[10] = src[0] * src[5];
+      tmp[11] = src[1] * src[4];
+
+      // calculate second 8 elements (cofactors)
+      r[8] = (tmp[0] * src[13] + tmp[3] * src[14] + tmp[4] * src[15]) - (tmp[1] * src[13] + tmp[2] * src[14] + tmp[5] * src[15]);
+      r[9] = (tmp[1] * src[12] + tmp[6] * src[14] + tmp[9] * src[15]) - (tmp[0] * src[12] + tmp[7] * src[14] + tmp[8] * src[15]);
+      r[10] = (tmp[2] * src[12] + tmp[7] * src[13] + tmp[10] * src[15]) - (tmp[3] * src[12] + tmp[6] * src[13] + tmp[11] * src[15]);
+      r[11] = (tmp[5] * src[12] + tmp[8] * src[13] + tmp[11] * src[14]) - (tmp[4] * src[12] + tmp[9] * src[13] + tmp[10] * src[14]);
+      r[12] = (tmp[2] * src[10] + tmp[5] * src[11] + tmp[1] * src[9]) - (tmp[4] * src[11] + tmp[0] * src[9] + tmp[3] * src[10]);
+      r[13] = (tmp[8] * src[11] + tmp[0] * src[8] + tmp[7] * src[10]) - (tmp[6] * src[10] + tmp[9] * src[11] + tmp[1] * src[8]);
+      r[14] = (tmp[6] * src[9] + tmp[11] * src[11] + tmp[3] * src[8]) - (tmp[10] * src[11] + tmp[2] * src[8] + tmp[7] * src[9]);
+      r[15] = (tmp[10] * src[10] + tmp[4] * src[8] + tmp[9] * src[9]) - (tmp[8] * src[9] + tmp[11] * src[10] + tmp[5] * src[8]);
+
+      // calculate determinant
+      float det = src[0] * r[0] + src[1] * r[1] + src[2] * r[2] + src[3] * r[3];
+
+      // calculate matrix inverse
+      float invdet = 1 / det;
+      for (int j = 0; j < 16; ++j)
+      {
+         r[j] *= invdet;
+      }
+
+      return det;
+   }
+#endif
+#if defined(IMGUIZMO_SIMD)
+   // 4 wide float vector. Loads and stores are unaligned so matrix_t/vec_t and user float arrays can be used directly.
+#if defined(IMGUIZMO_SIMD_SSE)
+   typedef __m128 simd4f;
+   // (a[x], a[y], b[z], b[w])
+#define IMGUIZMO_SIMD_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+   static inline simd4f SimdLoad(const float* p) { return _mm_loadu_ps(p); }
+   static inline void SimdStore(float* p, simd4f v) { _mm_storeu_ps(p, v); }
+   static inline simd4f SimdSplat(float f) { return _mm_set1_ps(f); }
+   static inline simd4f SimdSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+   static inline simd4f SimdAdd(simd4f a, simd4f b) { return _mm_add_ps(a, b); }
+   static inline simd4f SimdSub(simd4f a, simd4f b) { return _mm_sub_ps(a, b); }
+   static inline simd4f SimdMul(simd4f a, simd4f b) { return _mm_mul_ps(a, b); }
+   static inline simd4f SimdDiv(simd4f a, simd4f b) { return _mm_div_ps(a, b); }
+   // (a[0], b[0], a[1], b[1]) and (a[2], b[2], a[3], b[3])
+   static inline simd4f SimdZipLo(simd4f a, simd4f b) { return _mm_unpacklo_ps(a, b); }
+   static inline simd4f SimdZipHi(simd4f a, simd4f b) { return _mm_unpackhi_ps(a, b); }
+   static inline float SimdGetX(simd4f v) { return _mm_cvtss_f32(v); }
+   static inline simd4f SimdAbs(simd4f v) { return _mm_andnot_ps(_mm_set1_ps(-0.f), v); }
+   static inline simd4f SimdMax(simd4f a, simd4f b) { return _mm_max_ps(a, b); }
+   // true when every lane of a is <= the matching lane of b
+   static inline bool SimdAllLessEqual(simd4f a, simd4f b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)) == 0xF; }
+#else
+   typedef float32x4_t simd4f;
+   // (a[x], a[y], b[z], b[w])
+#if defined(__clang__)
+#define IMGUIZMO_SIMD_SHUFFLE(a, b, x, y, z, w) __builtin_shufflevector(a, b, x, y, (z) + 4, (w) + 4)
+#else
+#define IMGUIZMO_SIMD_SHUFFLE(a, b, x, y, z, w) __builtin_shuffle(a, b, (uint32x4_t){ x, y, (z) + 4, (w) + 4 })
+#endif
+   static inline simd4f SimdLoad(const float* p) { return vld1q_f32(p); }
+   static inline void SimdStore(float* p, simd4f v) { vst1q_f32(p, v); }
+   static inline simd4f SimdSplat(float f) { return vdupq_n_f32(f); }
+   static inline simd4f SimdSet(float x, float y, float z, float w) { const float v[4] = { x, y, z, w }; return vld1q_f32(v); }
+   static inline simd4f SimdAdd(simd4f a, simd4f b) { return vaddq_f32(a, b); }
+   static inline simd4f SimdSub(simd4f a, simd4f b) { return vsubq_f32(a, b); }
+   static inline simd4f SimdMul(simd4f a, simd4f b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+   static inline simd4f SimdDiv(simd4f a, simd4f b) { return vdivq_f32(a, b); }
+#else
+   // no vector divide on ARMv7, reciprocal estimate refined by two Newton-Raphson steps
+   static inline simd4f SimdDiv(simd4f a, simd4f b)
+   {
+      simd4f reciprocal = vrecpeq_f32(b);
+      reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+      reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+      return vmulq_f32(a, reciprocal);
+   }
+#endif
+   // (a[0], b[0], a[1], b[1]) and (a[2], b[2], a[3], b[3])
+   static inline simd4f SimdZipLo(simd4f a, simd4f b) { return vzipq_f32(a, b).val[0]; }
+   static inline simd4f SimdZipHi(simd4f a, simd4f b) { return vzipq_f32(a, b).val[1]; }
+   static inline float SimdGetX(simd4f v) { return vgetq_lane_f32(v, 0); }
+   static inline simd4f SimdAbs(simd4f v) { return vabsq_f32(v); }
+   static inline simd4f SimdMax(simd4f a, simd4f b) { return vmaxq_f32(a, b); }
+   // true when every lane of a is <= the matching lane of b
+   static inline bool SimdAllLessEqual(simd4f a, simd4f b)
+   {
+      const uint32x4_t mask = vcleq_f32(a, b);
+      const uint32x2_t half = vand_u32(vget_low_u32(mask), vget_high_u32(mask));
+      return (vget_lane_u32(half, 0) & vget_lane_u32(half, 1)) == 0xFFFFFFFFu;
+   }
+#endif
+   // (v[x], v[y], v[z], v[w])
+#define IMGUIZMO_SIMD_SWIZZLE(v, x, y, z, w) IMGUIZMO_SIMD_SHUFFLE(v, v, x, y, z, w)
+   // a * b + c, kept as separate multiply and add so results match the scalar path
+   static inline simd4f SimdMulAdd(simd4f a, simd4f b, simd4f c) { return SimdAdd(SimdMul(a, b), c); }
+
+   // b rows are loaded before anything is stored so r may alias a or b
+   static void SIMD_MatrixF_x_MatrixF(const float* a, const float* b, float* r)
+   {
+#if defined(IMGUIZMO_SIMD_AVX)
+      // two result rows per 256 bit register, _mm256_shuffle_ps broadcasts within each 128 bit lane
+      const __m256 a01 = _mm256_loadu_ps(a);
+      const __m256 a23 = _mm256_loadu_ps(a + 8);
+      const __m256 b0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b)), _mm_loadu_ps(b), 1);
+      const __m256 b1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b + 4)), _mm_loadu_ps(b + 4), 1);
+      const __m256 b2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b + 8)), _mm_loadu_ps(b + 8), 1);
+      const __m256 b3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b + 12)), _mm_loadu_ps(b + 12), 1);
+
+      __m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+      r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+      r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2));
+      r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3));
+
+      __m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+      r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+      r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2));
+      r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3));
+
+      _mm256_storeu_ps(r, r01);
+      _mm256_storeu_ps(r + 8, r23);
+#else
+      const simd4f b0 = SimdLoad(b);
+      const simd4f b1 = SimdLoad(b + 4);
+      const simd4f b2 = SimdLoad(b + 8);
+      const simd4f b3 = SimdLoad(b + 12);
+      for (int i = 0; i < 4; i++)
+      {
+         const simd4f ai = SimdLoad(a + i * 4);
+         simd4f ri = SimdMul(IMGUIZMO_SIMD_SWIZZLE(ai, 0, 0, 0, 0), b0);
+         ri = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(ai, 1, 1, 1, 1), b1, ri);
+         ri = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(ai, 2, 2, 2, 2), b2, ri);
+         ri = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(ai, 3, 3, 3, 3), b3, ri);
+         SimdStore(r + i * 4, ri);
+      }
+#endif
+   }
+
+   static void SIMD_Vec4F_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      const simd4f vv = SimdLoad(v);
+      simd4f res = SimdMul(IMGUIZMO_SIMD_SWIZZLE(vv, 0, 0, 0, 0), SimdLoad(m));
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(vv, 1, 1, 1, 1), SimdLoad(m + 4), res);
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(vv, 2, 2, 2, 2), SimdLoad(m + 8), res);
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(vv, 3, 3, 3, 3), SimdLoad(m + 12), res);
+      SimdStore(r, res);
+   }
+
+   static inline simd4f SimdTransformPoint(simd4f v, simd4f row0, simd4f row1, simd4f row2, simd4f row3)
+   {
+      simd4f res = SimdMul(IMGUIZMO_SIMD_SWIZZLE(v, 0, 0, 0, 0), row0);
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(v, 1, 1, 1, 1), row1, res);
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(v, 2, 2, 2, 2), row2, res);
+      return SimdAdd(res, row3);
+   }
+
+   static void SIMD_PointF_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      SimdStore(r, SimdTransformPoint(SimdLoad(v), SimdLoad(m), SimdLoad(m + 4), SimdLoad(m + 8), SimdLoad(m + 12)));
+   }
+
+   static void SIMD_VectorF_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      const simd4f vv = SimdLoad(v);
+      simd4f res = SimdMul(IMGUIZMO_SIMD_SWIZZLE(vv, 0, 0, 0, 0), SimdLoad(m));
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(vv, 1, 1, 1, 1), SimdLoad(m + 4), res);
+      res = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(vv, 2, 2, 2, 2), SimdLoad(m + 8), res);
+      SimdStore(r, res);
+   }
+
+   // 2x2 sub matrices stored as (m00, m01, m10, m11)
+   // A * B
+   static inline simd4f SimdMat2Mul(simd4f a, simd4f b)
+   {
+      return SimdAdd(SimdMul(a, IMGUIZMO_SIMD_SWIZZLE(b, 0, 3, 0, 3)), SimdMul(IMGUIZMO_SIMD_SWIZZLE(a, 1, 0, 3, 2), IMGUIZMO_SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+   }
+
+   // adj(A) * B
+   static inline simd4f SimdMat2AdjMul(simd4f a, simd4f b)
+   {
+      return SimdSub(SimdMul(IMGUIZMO_SIMD_SWIZZLE(a, 3, 3, 0, 0), b), SimdMul(IMGUIZMO_SIMD_SWIZZLE(a, 1, 1, 2, 2), IMGUIZMO_SIMD_SWIZZLE(b, 2, 3, 0, 1)));
+   }
+
+   // A * adj(B)
+   static inline simd4f SimdMat2MulAdj(simd4f a, simd4f b)
+   {
+      return SimdSub(SimdMul(a, IMGUIZMO_SIMD_SWIZZLE(b, 3, 0, 3, 0)), SimdMul(IMGUIZMO_SIMD_SWIZZLE(a, 1, 0, 3, 2), IMGUIZMO_SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+   }
+
+   // general inverse using the 2x2 block decomposition (M = | A B |, | C D |)
+   // the inverse of the transpose is the transpose of the inverse so storage order does not matter
+   static float SIMD_InverseMatrixF(const float* srcMatrix, float* r)
+   {
+      const simd4f row0 = SimdLoad(srcMatrix);
+      const simd4f row1 = SimdLoad(srcMatrix + 4);
+      const simd4f row2 = SimdLoad(srcMatrix + 8);
+      const simd4f row3 = SimdLoad(srcMatrix + 12);
+
+      const simd4f A = IMGUIZMO_SIMD_SHUFFLE(row0, row1, 0, 1, 0, 1);
+      const simd4f B = IMGUIZMO_SIMD_SHUFFLE(row0, row1, 2, 3, 2, 3);
+      const simd4f C = IMGUIZMO_SIMD_SHUFFLE(row2, row3, 0, 1, 0, 1);
+      const simd4f D = IMGUIZMO_SIMD_SHUFFLE(row2, row3, 2, 3, 2, 3);
+
+      // (|A|, |B|, |C|, |D|)
+      const simd4f detSub = SimdSub(
+         SimdMul(IMGUIZMO_SIMD_SHUFFLE(row0, row2, 0, 2, 0, 2), IMGUIZMO_SIMD_SHUFFLE(row1, row3, 1, 3, 1, 3)),
+         SimdMul(IMGUIZMO_SIMD_SHUFFLE(row0, row2, 1, 3, 1, 3), IMGUIZMO_SIMD_SHUFFLE(row1, row3, 0, 2, 0, 2)));
+      const simd4f detA = IMGUIZMO_SIMD_SWIZZLE(detSub, 0, 0, 0, 0);
+      const simd4f detB = IMGUIZMO_SIMD_SWIZZLE(detSub, 1, 1, 1, 1);
+      const simd4f detC = IMGUIZMO_SIMD_SWIZZLE(detSub, 2, 2, 2, 2);
+      const simd4f detD = IMGUIZMO_SIMD_SWIZZLE(detSub, 3, 3, 3, 3);
+
+      const simd4f D_C = SimdMat2AdjMul(D, C);
+      const simd4f A_B = SimdMat2AdjMul(A, B);
+      // adjugates of the result blocks, inverse = 1/|M| * | X Y |, | Z W |
+      simd4f X_ = SimdSub(SimdMul(detD, A), SimdMat2Mul(B, D_C));
+      simd4f W_ = SimdSub(SimdMul(detA, D), SimdMat2Mul(C, A_B));
+      simd4f Y_ = SimdSub(SimdMul(detB, C), SimdMat2MulAdj(D, A_B));
+      simd4f Z_ = SimdSub(SimdMul(detC, B), SimdMat2MulAdj(A, D_C));
+
+      // |M| = |A|*|D| + |B|*|C| - tr(adj(A)B * adj(D)C)
+      simd4f tr = SimdMul(A_B, IMGUIZMO_SIMD_SWIZZLE(D_C, 0, 2, 1, 3));
+      tr = SimdAdd(tr, IMGUIZMO_SIMD_SWIZZLE(tr, 2, 3, 0, 1));
+      tr = SimdAdd(tr, IMGUIZMO_SIMD_SWIZZLE(tr, 1, 0, 3, 2));
+      const float det = SimdGetX(SimdSub(SimdAdd(SimdMul(detA, detD), SimdMul(detB, detC)), tr));
+
+      const float invdet = 1 / det;
+      const simd4f rDetM = SimdMul(SimdSet(1.f, -1.f, -1.f, 1.f), SimdSplat(invdet));
+      X_ = SimdMul(X_, rDetM);
+      Y_ = SimdMul(Y_, rDetM);
+      Z_ = SimdMul(Z_, rDetM);
+      W_ = SimdMul(W_, rDetM);
+
+      // adjugate shuffle and block interleave in one go
+      SimdStore(r, IMGUIZMO_SIMD_SHUFFLE(X_, Y_, 3, 1, 3, 1));
+      SimdStore(r + 4, IMGUIZMO_SIMD_SHUFFLE(X_, Y_, 2, 0, 2, 0));
+      SimdStore(r + 8, IMGUIZMO_SIMD_SHUFFLE(Z_, W_, 3, 1, 3, 1));
+      SimdStore(r + 12, IMGUIZMO_SIMD_SHUFFLE(Z_, W_, 2, 0, 2, 0));
+      return det;
+   }
+
+   static inline simd4f SimdCross(simd4f a, simd4f b)
+   {
+      return SimdSub(SimdMul(IMGUIZMO_SIMD_SWIZZLE(a, 1, 2, 0, 3), IMGUIZMO_SIMD_SWIZZLE(b, 2, 0, 1, 3)), SimdMul(IMGUIZMO_SIMD_SWIZZLE(a, 2, 0, 1, 3), IMGUIZMO_SIMD_SWIZZLE(b, 1, 2, 0, 3)));
+   }
+
+   // 3x3 transpose of rows with w = 0, results have w = 0
+   static inline void SimdTranspose3(simd4f a, simd4f b, simd4f c, simd4f& x, simd4f& y, simd4f& z)
+   {
+      const simd4f zero = SimdSplat(0.f);
+      const simd4f ab01 = IMGUIZMO_SIMD_SHUFFLE(a, b, 0, 1, 0, 1);
+      const simd4f ab23 = IMGUIZMO_SIMD_SHUFFLE(a, b, 2, 3, 2, 3);
+      const simd4f c01 = IMGUIZMO_SIMD_SHUFFLE(c, zero, 0, 1, 0, 1);
+      const simd4f c23 = IMGUIZMO_SIMD_SHUFFLE(c, zero, 2, 3, 2, 3);
+      x = IMGUIZMO_SIMD_SHUFFLE(ab01, c01, 0, 2, 0, 2);
+      y = IMGUIZMO_SIMD_SHUFFLE(ab01, c01, 1, 3, 1, 3);
+      z = IMGUIZMO_SIMD_SHUFFLE(ab23, c23, 0, 2, 0, 2);
+   }
+
+   // rigid and affine inverse in one pass, the transposed basis used by the orthonormality test is the rigid inverse
+   // returns false for projective matrices, the general kernel has to be used then
+   static bool SIMD_InverseAffineMatrixF(const float* srcMatrix, float* r, float& det)
+   {
+      if (srcMatrix[3] != 0.f || srcMatrix[7] != 0.f || srcMatrix[11] != 0.f || srcMatrix[15] != 1.f)
+      {
+         return false;
+      }
+      const simd4f row0 = SimdLoad(srcMatrix);
+      const simd4f row1 = SimdLoad(srcMatrix + 4);
+      const simd4f row2 = SimdLoad(srcMatrix + 8);
+      const simd4f position = SimdLoad(srcMatrix + 12);
+
+      simd4f col0, col1, col2;
+      SimdTranspose3(row0, row1, row2, col0, col1, col2);
+
+      // deviation of the Gram matrix from identity: (|right|^2, |up|^2, |dir|^2, 0) - (1, 1, 1, 0) and (right.up, up.dir, dir.right, 0)
+      const simd4f lengths = SimdMulAdd(col2, col2, SimdMulAdd(col1, col1, SimdMul(col0, col0)));
+      const simd4f dots = SimdMulAdd(col2, IMGUIZMO_SIMD_SWIZZLE(col2, 1, 2, 0, 3), SimdMulAdd(col1, IMGUIZMO_SIMD_SWIZZLE(col1, 1, 2, 0, 3), SimdMul(col0, IMGUIZMO_SIMD_SWIZZLE(col0, 1, 2, 0, 3))));
+      const simd4f deviation = SimdMax(SimdAbs(SimdSub(lengths, SimdSet(1.f, 1.f, 1.f, 0.f))), SimdAbs(dots));
+
+      const simd4f c0 = SimdCross(row1, row2);
+      simd4f dot = SimdMul(row0, c0);
+      dot = SimdAdd(dot, IMGUIZMO_SIMD_SWIZZLE(dot, 2, 3, 0, 1));
+      det = SimdGetX(SimdAdd(dot, IMGUIZMO_SIMD_SWIZZLE(dot, 1, 0, 3, 2)));
+
+      simd4f inv0, inv1, inv2;
+      if (SimdAllLessEqual(deviation, SimdSplat(rigidTolerance)))
+      {
+         inv0 = col0;
+         inv1 = col1;
+         inv2 = col2;
+      }
+      else
+      {
+         // columns of the inverse are the basis cross products over the determinant
+         const simd4f invdet = SimdSplat(1 / det);
+         SimdTranspose3(SimdMul(c0, invdet), SimdMul(SimdCross(row2, row0), invdet), SimdMul(SimdCross(row0, row1), invdet), inv0, inv1, inv2);
+      }
+
+      simd4f translation = SimdMul(IMGUIZMO_SIMD_SWIZZLE(position, 0, 0, 0, 0), inv0);
+      translation = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(position, 1, 1, 1, 1), inv1, translation);
+      translation = SimdMulAdd(IMGUIZMO_SIMD_SWIZZLE(position, 2, 2, 2, 2), inv2, translation);
+
+      SimdStore(r, inv0);
+      SimdStore(r + 4, inv1);
+      SimdStore(r + 8, inv2);
+      SimdStore(r + 12, SimdSub(SimdSet(0.f, 0.f, 0.f, 1.f), translation));
+      return true;
+   }
+#endif
+
+#if defined(IMGUIZMO_SIMD) && defined(IMGUIZMO_SIMD_SELF_CHECK)
+   // asserts SIMD and scalar results agree, relative to the largest reference component
+   static void SimdSelfCheck(const float* simd, const float* reference, int count)
+   {
+      float scale = 1.f;
+      for (int i = 0; i < count; i++)
+      {
+         if (!(fabsf(reference[i]) <= FLT_MAX))
+         {
+            // singular inverse, nothing meaningful to compare
+            return;
+         }
+         scale = ImMax(scale, fabsf(reference[i]));
+      }
+      for (int i = 0; i < count; i++)
+      {
+         IM_ASSERT(fabsf(simd[i] - reference[i]) <= IMGUIZMO_SIMD_SELF_CHECK_TOLERANCE * scale && "SIMD result differs from the scalar reference");
+      }
+   }
+#define IMGUIZMO_SIMD_DISPATCH(function, count, ...) \
+   { \
+      float reference[count]; \
+      FPU_##function(__VA_ARGS__, reference); \
+      SIMD_##function(__VA_ARGS__, r); \
+      SimdSelfCheck(r, reference, count); \
+   }
+#elif defined(IMGUIZMO_SIMD)
+#define IMGUIZMO_SIMD_DISPATCH(function, count, ...) SIMD_##function(__VA_ARGS__, r);
+#else
+#define IMGUIZMO_SIMD_DISPATCH(function, count, ...) FPU_##function(__VA_ARGS__, r);
+#endif
+
+   static void MatrixF_x_MatrixF(const float* a, const float* b, float* r)
+   {
+      IMGUIZMO_SIMD_DISPATCH(MatrixF_x_MatrixF, 16, a, b)
+   }
+
+   static void Vec4F_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      IMGUIZMO_SIMD_DISPATCH(Vec4F_x_MatrixF, 4, v, m)
+   }
+
+   static void PointF_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      IMGUIZMO_SIMD_DISPATCH(PointF_x_MatrixF, 4, v, m)
+   }
+
+   static void VectorF_x_MatrixF(const float* v, const float* m, float* r)
+   {
+      IMGUIZMO_SIMD_DISPATCH(VectorF_x_MatrixF, 4, v, m)
+   }
+
+   static float InverseMatrixF(const float* srcMatrix, float* r)
+   {
+#if defined(IMGUIZMO_SIMD) && defined(IMGUIZMO_SIMD_SELF_CHECK)
+      float reference[16];
+      FPU_InverseMatrixF(srcMatrix, reference);
+      const float det = SIMD_InverseMatrixF(srcMatrix, r);
+      SimdSelfCheck(r, reference, 16);
+      return det;
+#elif defined(IMGUIZMO_SIMD)
+      return SIMD_InverseMatrixF(srcMatrix, r);
+#else
+      return FPU_InverseMatrixF(srcMatrix, r);
+#endif
+   }
+
    void Frustum(float left, float right, float bottom, float top, float znear, float zfar, float* m16)
    {
       float temp, temp2, temp3, temp4;
@@ -362,12 +831,12 @@ namespace IMGUIZMO_NAMESPACE
          matrix_t tmp;
          tmp = *this;
 
-         FPU_MatrixF_x_MatrixF((float*)&tmp, (float*)&matrix, (float*)this);
+         MatrixF_x_MatrixF((float*)&tmp, (float*)&matrix, (float*)this);
       }
 
       void Multiply(const matrix_t& m1, const matrix_t& m2)
       {
-         FPU_MatrixF_x_MatrixF((float*)&m1, (float*)&m2, (float*)this);
+         MatrixF_x_MatrixF((float*)&m1, (float*)&m2, (float*)this);
       }
 
       float GetDeterminant() const
@@ -377,6 +846,8 @@ namespace IMGUIZMO_NAMESPACE
       }
 
       float Inverse(const matrix_t& srcMatrix, bool affine = false);
+      // inverse through the cheapest kernel that is exact for the structure of srcMatrix (see ClassifyMatrix)
+      float InverseClassified(const matrix_t& srcMatrix);
       void SetToIdentity()
       {
          v.right.Set(1.f, 0.f, 0.f, 0.f);
@@ -409,17 +880,7 @@ namespace IMGUIZMO_NAMESPACE
 
    void vec_t::Transform(const matrix_t& matrix)
    {
-      vec_t out;
-
-      out.x = x * matrix.m[0][0] + y * matrix.m[1][0] + z * matrix.m[2][0] + w * matrix.m[3][0];
-      out.y = x * matrix.m[0][1] + y * matrix.m[1][1] + z * matrix.m[2][1] + w * matrix.m[3][1];
-      out.z = x * matrix.m[0][2] + y * matrix.m[1][2] + z * matrix.m[2][2] + w * matrix.m[3][2];
-      out.w = x * matrix.m[0][3] + y * matrix.m[1][3] + z * matrix.m[2][3] + w * matrix.m[3][3];
-
-      x = out.x;
-      y = out.y;
-      z = out.z;
-      w = out.w;
+      Vec4F_x_MatrixF(&x, matrix.m16, &x);
    }
 
    void vec_t::Transform(const vec_t& s, const matrix_t& matrix)
@@ -430,33 +891,45 @@ namespace IMGUIZMO_NAMESPACE
 
    void vec_t::TransformPoint(const matrix_t& matrix)
    {
-      vec_t out;
-
-      out.x = x * matrix.m[0][0] + y * matrix.m[1][0] + z * matrix.m[2][0] + matrix.m[3][0];
-      out.y = x * matrix.m[0][1] + y * matrix.m[1][1] + z * matrix.m[2][1] + matrix.m[3][1];
-      out.z = x * matrix.m[0][2] + y * matrix.m[1][2] + z * matrix.m[2][2] + matrix.m[3][2];
-      out.w = x * matrix.m[0][3] + y * matrix.m[1][3] + z * matrix.m[2][3] + matrix.m[3][3];
-
-      x = out.x;
-      y = out.y;
-      z = out.z;
-      w = out.w;
+      PointF_x_MatrixF(&x, matrix.m16, &x);
    }
 
    void vec_t::TransformVector(const matrix_t& matrix)
    {
-      vec_t out;
+      VectorF_x_MatrixF(&x, matrix.m16, &x);
+   }
 
-      out.x = x * matrix.m[0][0] + y * matrix.m[1][0] + z * matrix.m[2][0];
-      out.y = x * matrix.m[0][1] + y * matrix.m[1][1] + z * matrix.m[2][1];
-      out.z = x * matrix.m[0][2] + y * matrix.m[1][2] + z * matrix.m[2][2];
-      out.w = x * matrix.m[0][3] + y * matrix.m[1][3] + z * matrix.m[2][3];
+#if !defined(IMGUIZMO_SIMD)
+   // SIMD builds classify inside SIMD_InverseAffineMatrixF
+   enum MATRIX_CLASS
+   {
+      MATRIX_RIGID,   // orthonormal basis + translation, inverse is the transpose
+      MATRIX_AFFINE,  // scaled/sheared basis + translation, 3x3 inverse
+      MATRIX_GENERAL, // projective, full 4x4 inverse
+   };
 
-      x = out.x;
-      y = out.y;
-      z = out.z;
-      w = out.w;
+   // cheap structural check: last column first, then orthonormality of the basis rows
+   static MATRIX_CLASS ClassifyMatrix(const matrix_t& matrix)
+   {
+      if (matrix.m[0][3] != 0.f || matrix.m[1][3] != 0.f || matrix.m[2][3] != 0.f || matrix.m[3][3] != 1.f)
+      {
+         return MATRIX_GENERAL;
+      }
+      const vec_t& right = matrix.v.right;
+      const vec_t& up = matrix.v.up;
+      const vec_t& dir = matrix.v.dir;
+      if (fabsf(right.Dot3(right) - 1.f) > rigidTolerance ||
+         fabsf(up.Dot3(up) - 1.f) > rigidTolerance ||
+         fabsf(dir.Dot3(dir) - 1.f) > rigidTolerance ||
+         fabsf(right.Dot3(up)) > rigidTolerance ||
+         fabsf(right.Dot3(dir)) > rigidTolerance ||
+         fabsf(up.Dot3(dir)) > rigidTolerance)
+      {
+         return MATRIX_AFFINE;
+      }
+      return MATRIX_RIGID;
    }
+#endif
 
    float matrix_t::Inverse(const matrix_t& srcMatrix, bool affine)
    {
@@ -464,96 +937,78 @@ namespace IMGUIZMO_NAMESPACE
 
       if (affine)
       {
-         det = GetDeterminant();
+         // copy so srcMatrix may alias this
+         const matrix_t src = srcMatrix;
+         det = src.GetDeterminant();
          float s = 1 / det;
-         m[0][0] = (srcMatrix.m[1][1] * srcMatrix.m[2][2] - srcMatrix.m[1][2] * srcMatrix.m[2][1]) * s;
-         m[0][1] = (srcMatrix.m[2][1] * srcMatrix.m[0][2] - srcMatrix.m[2][2] * srcMatrix.m[0][1]) * s;
-         m[0][2] = (srcMatrix.m[0][1] * srcMatrix.m[1][2] - srcMatrix.m[0][2] * srcMatrix.m[1][1]) * s;
-         m[1][0] = (srcMatrix.m[1][2] * srcMatrix.m[2][0] - srcMatrix.m[1][0] * srcMatrix.m[2][2]) * s;
-         m[1][1] = (srcMatrix.m[2][2] * srcMatrix.m[0][0] - srcMatrix.m[2][0] * srcMatrix.m[0][2]) * s;
-         m[1][2] = (srcMatrix.m[0][2] * srcMatrix.m[1][0] - srcMatrix.m[0][0] * srcMatrix.m[1][2]) * s;
-         m[2][0] = (srcMatrix.m[1][0] * srcMatrix.m[2][1] - srcMatrix.m[1][1] * srcMatrix.m[2][0]) * s;
-         m[2][1] = (srcMatrix.m[2][0] * srcMatrix.m[0][1] - srcMatrix.m[2][1] * srcMatrix.m[0][0]) * s;
-         m[2][2] = (srcMatrix.m[0][0] * srcMatrix.m[1][1] - srcMatrix.m[0][1] * srcMatrix.m[1][0]) * s;
-         m[3][0] = -(m[0][0] * srcMatrix.m[3][0] + m[1][0] * srcMatrix.m[3][1] + m[2][0] * srcMatrix.m[3][2]);
-         m[3][1] = -(m[0][1] * srcMatrix.m[3][0] + m[1][1] * srcMatrix.m[3][1] + m[2][1] * srcMatrix.m[3][2]);
-         m[3][2] = -(m[0][2] * srcMatrix.m[3][0] + m[1][2] * srcMatrix.m[3][1] + m[2][2] * srcMatrix.m[3][2]);
+         m[0][0] = (src.m[1][1] * src.m[2][2] - src.m[1][2] * src.m[2][1]) * s;
+         m[0][1] = (src.m[2][1] * src.m[0][2] - src.m[2][2] * src.m[0][1]) * s;
+         m[0][2] = (src.m[0][1] * src.m[1][2] - src.m[0][2] * src.m[1][1]) * s;
+         m[0][3] = 0.f;
+         m[1][0] = (src.m[1][2] * src.m[2][0] - src.m[1][0] * src.m[2][2]) * s;
+         m[1][1] = (src.m[2][2] * src.m[0][0] - src.m[2][0] * src.m[0][2]) * s;
+         m[1][2] = (src.m[0][2] * src.m[1][0] - src.m[0][0] * src.m[1][2]) * s;
+         m[1][3] = 0.f;
+         m[2][0] = (src.m[1][0] * src.m[2][1] - src.m[1][1] * src.m[2][0]) * s;
+         m[2][1] = (src.m[2][0] * src.m[0][1] - src.m[2][1] * src.m[0][0]) * s;
+         m[2][2] = (src.m[0][0] * src.m[1][1] - src.m[0][1] * src.m[1][0]) * s;
+         m[2][3] = 0.f;
+         m[3][0] = -(m[0][0] * src.m[3][0] + m[1][0] * src.m[3][1] + m[2][0] * src.m[3][2]);
+         m[3][1] = -(m[0][1] * src.m[3][0] + m[1][1] * src.m[3][1] + m[2][1] * src.m[3][2]);
+         m[3][2] = -(m[0][2] * src.m[3][0] + m[1][2] * src.m[3][1] + m[2][2] * src.m[3][2]);
+         m[3][3] = 1.f;
       }
       else
       {
-         // transpose matrix
-         float src[16];
-         for (int i = 0; i < 4; ++i)
-         {
-            src[i] = srcMatrix.m16[i * 4];
-            src[i + 4] = srcMatrix.m16[i * 4 + 1];
-            src[i + 8] = srcMatrix.m16[i * 4 + 2];
-            src[i + 12] = srcMatrix.m16[i * 4 + 3];
-         }
-
-         // calculate pairs for first 8 elements (cofactors)
-         float tmp[12]; // temp array for pairs
-         tmp[0] = src[10] * src[15];
-         tmp[1] = src[11] * src[14];
-         tmp[2] = src[9] * src[15];
-         tmp[3] = src[11] * src[13];
-         tmp[4] = src[9] * src[14];
-         tmp[5] = src[10] * src[13];
-         tmp[6] = src[8] * src[15];
-         tmp[7] = src[11] * src[12];
-         tmp[8] = src[8] * src[14];
-         tmp[9] = src[10] * src[12];
-         tmp[10] = src[8] * src[13];
-         tmp[11] = src[9] * src[12];
-
-         // calculate first 8 elements (cofactors)
-         m16[0] = (tmp[0] * src[5] + tmp[3] * src[6] + tmp[4] * src[7]) - (tmp[1] * src[5] + tmp[2] * src[6] + tmp[5] * src[7]);
-         m16[1] = (tmp[1] * src[4] + tmp[6] * src[6] + tmp[9] * src[7]) - (tmp[0] * src[4] + tmp[7] * src[6] + tmp[8] * src[7]);
-         m16[2] = (tmp[2] * src[4] + tmp[7] * src[5] + tmp[10] * src[7]) - (tmp[3] * src[4] + tmp[6] * src[5] + tmp[11] * src[7]);
-         m16[3] = (tmp[5] * src[4] + tmp[8] * src[5] + tmp[11] * src[6]) - (tmp[4] * src[4] + tmp[9] * src[5] + tmp[10] * src[6]);
-         m16[4] = (tmp[1] * src[1] + tmp[2] * src[2] + tmp[5] * src[3]) - (tmp[0] * src[1] + tmp[3] * src[2] + tmp[4] * src[3]);
-         m16[5] = (tmp[0] * src[0] + tmp[7] * src[2] + tmp[8] * src[3]) - (tmp[1] * src[0] + tmp[6] * src[2] + tmp[9] * src[3]);
-         m16[6] = (tmp[3] * src[0] + tmp[6] * src[1] + tmp[11] * src[3]) - (tmp[2] * src[0] + tmp[7] * src[1] + tmp[10] * src[3]);
-         m16[7] = (tmp[4] * src[0] + tmp[9] * src[1] + tmp[10] * src[2]) - (tmp[5] * src[0] + tmp[8] * src[1] + tmp[11] * src[2]);
-
-         // calculate pairs for second 8 elements (cofactors)
-         tmp[0] = src[2] * src[7];
-         tmp[1] = src[3] * src[6];
-         tmp[2] = src[1] * src[7];
-         tmp[3] = src[3] * src[5];
-         tmp[4] = src[1] * src[6];
-         tmp[5] = src[2] * src[5];
-         tmp[6] = src[0] * src[7];
-         tmp[7] = src[3] * src[4];
-         tmp[8] = src[0] * src[6];
-         tmp[9] = src[2] * src[4];
-         tmp[10] = src[0] * src[5];
-         tmp[11] = src[1] * src[4];
-
-         // calculate second 8 elements (cofactors)
-         m16[8] = (tmp[0] * src[13] + tmp[3] * src[14] + tmp[4] * src[15]) - (tmp[1] * src[13] + tmp[2] * src[14] + tmp[5] * src[15]);
-         m16[9] = (tmp[1] * src[12] + tmp[6] * src[14] + tmp[9] * src[15]) - (tmp[0] * src[12] + tmp[7] * src[14] + tmp[8] * src[15]);
-         m16[10] = (tmp[2] * src[12] + tmp[7] * src[13] + tmp[10] * src[15]) - (tmp[3] * src[12] + tmp[6] * src[13] + tmp[11] * src[15]);
-         m16[11] = (tmp[5] * src[12] + tmp[8] * src[13] + tmp[11] * src[14]) - (tmp[4] * src[12] + tmp[9] * src[13] + tmp[10] * src[14]);
-         m16[12] = (tmp[2] * src[10] + tmp[5] * src[11] + tmp[1] * src[9]) - (tmp[4] * src[11] + tmp[0] * src[9] + tmp[3] * src[10]);
-         m16[13] = (tmp[8] * src[11] + tmp[0] * src[8] + tmp[7] * src[10]) - (tmp[6] * src[10] + tmp[9] * src[11] + tmp[1] * src[8]);
-         m16[14] = (tmp[6] * src[9] + tmp[11] * src[11] + tmp[3] * src[8]) - (tmp[10] * src[11] + tmp[2] * src[8] + tmp[7] * src[9]);
-         m16[15] = (tmp[10] * src[10] + tmp[4] * src[8] + tmp[9] * src[9]) - (tmp[8] * src[9] + tmp[11] * src[10] + tmp[5] * src[8]);
-
-         // calculate determinant
-         det = src[0] * m16[0] + src[1] * m16[1] + src[2] * m16[2] + src[3] * m16[3];
-
-         // calculate matrix inverse
-         float invdet = 1 / det;
-         for (int j = 0; j < 16; ++j)
-         {
-            m16[j] *= invdet;
-         }
+         det = InverseMatrixF(srcMatrix.m16, m16);
       }
 
       return det;
    }
 
+   float matrix_t::InverseClassified(const matrix_t& srcMatrix)
+   {
+#if defined(IMGUIZMO_SIMD)
+#if defined(IMGUIZMO_SIMD_SELF_CHECK)
+      float reference[16];
+      FPU_InverseMatrixF(srcMatrix.m16, reference);
+#endif
+      float det;
+      if (!SIMD_InverseAffineMatrixF(srcMatrix.m16, m16, det))
+      {
+         return Inverse(srcMatrix);
+      }
+#if defined(IMGUIZMO_SIMD_SELF_CHECK)
+      SimdSelfCheck(m16, reference, 16);
+#endif
+      return det;
+#else
+      switch (ClassifyMatrix(srcMatrix))
+      {
+      case MATRIX_RIGID:
+      {
+         const matrix_t src = srcMatrix;
+         for (int i = 0; i < 3; i++)
+         {
+            m[i][0] = src.m[0][i];
+            m[i][1] = src.m[1][i];
+            m[i][2] = src.m[2][i];
+            m[i][3] = 0.f;
+         }
+         m[3][0] = -src.v.position.Dot3(src.v.right);
+         m[3][1] = -src.v.position.Dot3(src.v.up);
+         m[3][2] = -src.v.position.Dot3(src.v.dir);
+         m[3][3] = 1.f;
+         return src.GetDeterminant();
+      }
+      case MATRIX_AFFINE:
+         return Inverse(srcMatrix, true);
+      default:
+         return Inverse(srcMatrix);
+      }
+#endif
+   }
+
    void matrix_t::RotationAxis(const vec_t& axis, float angle)
    {
       float length2 = axis.LengthSq();
@@ -648,6 +1103,7 @@ namespace IMGUIZMO_NAMESPACE
       ScaleLineCircleSize        = 6.0f;
       HatchedAxisLineThickness   = 6.0f;
       CenterCircleSize           = 6.0f;
+      CircleTessellationMaxError = 0.3f;
 
       // initialize default colors
       Colors[DIRECTION_X]           = ImVec4(0.666f, 0.000f, 0.000f, 1.000f);
@@ -667,6 +1123,113 @@ namespace IMGUIZMO_NAMESPACE
       Colors[TEXT_SHADOW]           = ImVec4(0.000f, 0.000f, 0.000f, 1.000f);
    }
 
+   // frame-scoped linear allocator for temporaries whose size depends on the input.
+   // Allocations stay valid until the ImGui frame changes. Memory is kept and grows to the largest frame seen,
+   // so steady frames do no heap allocation.
+   struct ScratchArena
+   {
+      struct Block
+      {
+         char* mData;
+         size_t mSize;
+      };
+      ImVector<Block> mBlocks; // the last block is the one being filled
+      size_t mUsed = 0;        // bytes used in the last block
+      size_t mFrameBytes = 0;  // bytes handed out this frame, alignment included
+      size_t mHighWater = 0;   // largest mFrameBytes seen
+      int mFrameCount = -1;
+
+      ~ScratchArena()
+      {
+         FreeBlocks();
+      }
+
+      void FreeBlocks()
+      {
+         for (int i = 0; i < mBlocks.Size; i++)
+         {
+            IM_FREE(mBlocks[i].mData);
+         }
+         mBlocks.clear();
+      }
+
+      // start a new frame, merging the blocks of a frame that had to grow into one
+      void Reset()
+      {
+         if (mBlocks.Size > 1)
+         {
+            size_t size = 0;
+            for (int i = 0; i < mBlocks.Size; i++)
+            {
+               size += mBlocks[i].mSize;
+            }
+            FreeBlocks();
+            Block block = { (char*)IM_ALLOC(size), size };
+            mBlocks.push_back(block);
+         }
+         mUsed = 0;
+         mFrameBytes = 0;
+      }
+
+      void* Alloc(size_t size, size_t alignment = 16)
+      {
+         const int frameCount = ImGui::GetFrameCount();
+         if (frameCount != mFrameCount)
+         {
+            mFrameCount = frameCount;
+            Reset();
+         }
+
+         size_t offset = mBlocks.Size ? ((mUsed + alignment - 1) & ~(alignment - 1)) : 0;
+         if (!mBlocks.Size || offset + size > mBlocks.back().mSize)
+         {
+            // earlier allocations of this frame stay where they are, the next Reset merges the blocks
+            const size_t blockSize = ImMax(size + alignment, ImMax(mFrameBytes, (size_t)4096));
+            Block block = { (char*)IM_ALLOC(blockSize), blockSize };
+            mBlocks.push_back(block);
+            mFrameBytes += mBlocks.Size > 1 ? mBlocks[mBlocks.Size - 2].mSize - mUsed : 0;
+            mUsed = 0;
+            offset = ((size_t)(-(intptr_t)block.mData)) & (alignment - 1);
+         }
+         void* result = mBlocks.back().mData + offset;
+         mFrameBytes += offset - mUsed + size;
+         mUsed = offset + size;
+         mHighWater = ImMax(mHighWater, mFrameBytes);
+         return result;
+      }
+   };
+
+   // view-dependent data (view * projection, inverses, reversed depth), rebuilt only when the view or projection actually change
+   struct ViewProjectionCache
+   {
+      matrix_t mView;
+      matrix_t mProjection;
+      matrix_t mViewProjection;
+      matrix_t mViewProjectionInverse;
+      matrix_t mViewInverse; // camera basis and eye
+      bool mReversed = false;
+      bool mValid = false;
+
+      void Update(const matrix_t& view, const matrix_t& projection)
+      {
+         if (mValid && !memcmp(&mView, &view, sizeof(matrix_t)) && !memcmp(&mProjection, &projection, sizeof(matrix_t)))
+         {
+            return;
+         }
+         mView = view;
+         mProjection = projection;
+         mViewProjection = mView * mProjection;
+         mViewProjectionInverse.Inverse(mViewProjection);
+         mViewInverse.InverseClassified(mView);
+
+         vec_t nearPos, farPos;
+         nearPos.Transform(makeVect(0, 0, 1.f, 1.f), mProjection);
+         farPos.Transform(makeVect(0, 0, 2.f, 1.f), mProjection);
+         mReversed = (nearPos.z / nearPos.w) > (farPos.z / farPos.w);
+         mValid = true;
+      }
+   };
+
    struct Context
    {
       Context() : mbUsing(false), mbUsingViewManipulate(false), mbEnable(true), mbUsingBounds(false)
@@ -674,8 +1237,24 @@ namespace IMGUIZMO_NAMESPACE
 		  mIDStack.push_back(-1);
       }
 
-      ImDrawList* mDrawList;
+      ImDrawList* mDrawList = nullptr;
+      int mFrameCount = -1;         // ImGui frame BeginFrame last ran for
+      int mDrawListFrameCount = -1; // ImGui frame SetDrawlist was last called in
       Style mStyle;
+      ImU32 mStyleColorsU32[COLOR::COUNT] = {}; // mStyle.Colors packed, up to date when mStyleColorsVersion == mStyleVersion
+      ImVec4 mStyleColorsPacked[COLOR::COUNT] = {}; // the colors mStyleColorsU32 was packed from
+      unsigned int mStyleVersion = 1;
+      unsigned int mStyleColorsVersion = 0;
+
+      // named styles stored by CreateStyle, with their colors already packed
+      struct StylePreset
+      {
+         ImGuiID mNameHash;
+         char* mName; // ImStrdup copy, compared on a hash match so colliding names stay apart
+         Style mStyle;
+         ImU32 mColorsU32[COLOR::COUNT];
+      };
+      ImVector<StylePreset> mStylePresets;
 
       MODE mMode;
       matrix_t mViewMat;
@@ -688,6 +1267,11 @@ namespace IMGUIZMO_NAMESPACE
       matrix_t mMVP;
       matrix_t mMVPLocal; // MVP with full model matrix whereas mMVP's model matrix might only be translation in case of World space edition
       matrix_t mViewProjection;
+      ViewProjectionCache mCamera; // set by SetCamera, used for NULL view or projection
+      ViewProjectionCache mViewProjectionCache;
+      ViewProjectionCache mViewCubeProjectionCache;
+      const ViewProjectionCache* mCallCamera = nullptr; // camera of the Manipulate call in progress
+      ScratchArena mScratch;
 
       vec_t mModelScaleOrigin;
       vec_t mCameraEye;
@@ -716,6 +1300,8 @@ namespace IMGUIZMO_NAMESPACE
       vec_t mTranslationPlanOrigin;
       vec_t mMatrixOrigin;
       vec_t mTranslationLastDelta;
+      TranslationSnapCallback mTranslationSnapCallback = nullptr;
+      void* mTranslationSnapUserData = nullptr;
 
       // rotation
       vec_t mRotationVectorSource;
@@ -748,6 +1334,10 @@ namespace IMGUIZMO_NAMESPACE
       bool mbUsingBounds;
       matrix_t mBoundsMatrix;
 
+      // ManipulateMany gizmo, kept while the call with mManyGizmoID is in use
+      matrix_t mManyGizmo;
+      ImGuiID mManyGizmoID = 0;
+
       //
       int mCurrentOperation;
 
@@ -764,6 +1354,8 @@ namespace IMGUIZMO_NAMESPACE
       bool mbOverGizmoHotspot = false;
 
       ImGuiWindow* mAlternativeWindow = nullptr;
+      ImDrawList* mDrawListWindowSource = nullptr; // draw list mDrawListWindow was resolved for
+      ImGuiWindow* mDrawListWindow = nullptr;
       ImVector<ImGuiID> mIDStack;
       ImGuiID mEditingID = -1;
       OPERATION mOperation = OPERATION(-1);
@@ -771,11 +1363,71 @@ namespace IMGUIZMO_NAMESPACE
       bool mAllowAxisFlip = true;
       float mGizmoSizeClipSpace = 0.1f;
 
+      // ComputeTripodAxisAndVisibility results when not using, per [localCoordinates][axis]
+      // valid until the next ComputeContext or a change to the settings they depend on
+      struct TripodCache
+      {
+         bool mValid = false;
+         vec_t mDirAxis;
+         vec_t mDirPlaneX;
+         vec_t mDirPlaneY;
+         bool mBelowAxisLimit;
+         bool mBelowPlaneLimit;
+         float mAxisFactor[3]; // axis, plane x, plane y
+      };
+      TripodCache mTripodCache[2][3];
+
+      // rotation circle tessellation shared by drawing and picking, per circle axis (0 = Z, 1 = Y, 2 = X)
+      // valid until the next ComputeContext
+      struct RotationCircle
+      {
+         float mAngleStart;    // model space angle of the first vertex
+         int mSegmentCount;    // per half circle, a power of two dividing halfCircleSegmentCount
+      };
+      RotationCircle mRotationCircles[3];
+      bool mRotationCirclesValid = false;
+      int mRadiusSquareSegmentCount = 64; // segments of the screen rotation ring
+
+      // screen circle around everything the move, rotate and scale hit tests can reach, set by ComputeContext.
+      // FLT_MAX radius when the gizmo crosses the camera plane and has no bounded projection
+      ImVec2 mHitBoundsCenter;
+      float mHitBoundsRadiusSq = FLT_MAX;
+
+      // GetMoveType, GetRotateType and GetScaleType results, so IsOver reuses the tests Manipulate already ran
+      // valid for one operation and mouse position until the next ComputeContext or a tripod setting change
+      enum { HOVER_MOVE, HOVER_ROTATE, HOVER_SCALE, HOVER_COUNT };
+      struct HoverCache
+      {
+         bool mValid = false;
+         OPERATION mOperation;
+         ImVec2 mMousePos;
+         float mRadiusSquareCenter; // the screen rotation ring is resized when it is drawn
+         int mType;
+         vec_t mHitProportion;
+      };
+      HoverCache mHoverCache[HOVER_COUNT];
+
       inline ImGuiID GetCurrentID() {return mIDStack.back();}
    };
 
    static Context gContext;
 
+   static void InvalidateTripodCache()
+   {
+      for (int local = 0; local < 2; local++)
+      {
+         for (int axis = 0; axis < 3; axis++)
+         {
+            gContext.mTripodCache[local][axis].mValid = false;
+         }
+      }
+      // hit tests are derived from the tripod
+      for (int i = 0; i < Context::HOVER_COUNT; i++)
+      {
+         gContext.mHoverCache[i].mValid = false;
+      }
+   }
+
    static const vec_t directionUnary[3] = { makeVect(1.f, 0.f, 0.f), makeVect(0.f, 1.f, 0.f), makeVect(0.f, 0.f, 1.f) };
    static const char* translationInfoMask[] = { "X : %5.3f", "Y : %5.3f", "Z : %5.3f",
       "Y : %5.3f Z : %5.3f", "X : %5.3f Z : %5.3f", "X : %5.3f Y : %5.3f",
@@ -787,8 +1439,27 @@ namespace IMGUIZMO_NAMESPACE
    static const float quadMax = 0.8f;
    static const float quadUV[8] = { quadMin, quadMin, quadMin, quadMax, quadMax, quadMax, quadMax, quadMin };
    static const int halfCircleSegmentCount = 64;
+   static const int minHalfCircleSegmentCount = 4;
    static const float snapTension = 0.5f;
 
+   // cos/sin of i * PI / halfCircleSegmentCount, i in [0, 2 * halfCircleSegmentCount]
+   struct UnitCircleTable
+   {
+      float mCos[2 * halfCircleSegmentCount + 1];
+      float mSin[2 * halfCircleSegmentCount + 1];
+
+      UnitCircleTable()
+      {
+         for (int i = 0; i <= 2 * halfCircleSegmentCount; i++)
+         {
+            double ng = 3.14159265358979323846 * (double)i / (double)halfCircleSegmentCount;
+            mCos[i] = (float)cos(ng);
+            mSin[i] = (float)sin(ng);
+         }
+      }
+   };
+   static const UnitCircleTable unitCircle;
+
    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
    //
    static int GetMoveType(OPERATION op, vec_t* gizmoHitProportion);
@@ -797,13 +1468,87 @@ namespace IMGUIZMO_NAMESPACE
 
    Style& GetStyle()
    {
+      // the caller may write through the reference, check the colors on next use
+      gContext.mStyleVersion++;
       return gContext.mStyle;
    }
 
+   int CreateStyle(const char* name, const Style& style)
+   {
+      int handle = FindStyle(name);
+      if (handle < 0)
+      {
+         handle = gContext.mStylePresets.Size;
+         gContext.mStylePresets.resize(handle + 1);
+         gContext.mStylePresets[handle].mNameHash = ImHashStr(name);
+         gContext.mStylePresets[handle].mName = ImStrdup(name);
+      }
+      Context::StylePreset& preset = gContext.mStylePresets[handle];
+      preset.mStyle = style;
+      for (int i = 0; i < COLOR::COUNT; i++)
+      {
+         preset.mColorsU32[i] = ImGui::ColorConvertFloat4ToU32(style.Colors[i]);
+      }
+      return handle;
+   }
+
+   int FindStyle(const char* name)
+   {
+      const ImGuiID id = ImHashStr(name);
+      for (int i = 0; i < gContext.mStylePresets.Size; i++)
+      {
+         if (gContext.mStylePresets[i].mNameHash == id && strcmp(gContext.mStylePresets[i].mName, name) == 0)
+         {
+            return i;
+         }
+      }
+      return -1;
+   }
+
+   bool UseStyle(int handle)
+   {
+      if (handle < 0 || handle >= gContext.mStylePresets.Size)
+      {
+         return false;
+      }
+      // a copy of the style and of its packed colors, nothing to repack
+      const Context::StylePreset& preset = gContext.mStylePresets[handle];
+      gContext.mStyle = preset.mStyle;
+      memcpy(gContext.mStyleColorsU32, preset.mColorsU32, sizeof(preset.mColorsU32));
+      memcpy(gContext.mStyleColorsPacked, preset.mStyle.Colors, sizeof(preset.mStyle.Colors));
+      // a new version that is already packed: only writes after this one repack
+      gContext.mStyleVersion++;
+      gContext.mStyleColorsVersion = gContext.mStyleVersion;
+      return true;
+   }
+
+   void* ScratchAlloc(size_t size)
+   {
+      return gContext.mScratch.Alloc(size);
+   }
+
+   size_t GetScratchHighWaterMark()
+   {
+      return gContext.mScratch.mHighWater;
+   }
+
    static ImU32 GetColorU32(int idx)
    {
       IM_ASSERT(idx < COLOR::COUNT);
-      return ImGui::ColorConvertFloat4ToU32(gContext.mStyle.Colors[idx]);
+      if (gContext.mStyleColorsVersion != gContext.mStyleVersion)
+      {
+         // GetStyle() calls that only read leave the colors as they were packed
+         if (memcmp(gContext.mStyleColorsPacked, gContext.mStyle.Colors, sizeof(gContext.mStyleColorsPacked)) != 0)
+         {
+            for (int i = 0; i < COLOR::COUNT; i++)
+            {
+               gContext.mStyleColorsU32[i] = ImGui::ColorConvertFloat4ToU32(gContext.mStyle.Colors[i]);
+            }
+            memcpy(gContext.mStyleColorsPacked, gContext.mStyle.Colors, sizeof(gContext.mStyleColorsPacked));
+         }
+         gContext.mStyleColorsVersion = gContext.mStyleVersion;
+      }
+      return gContext.mStyleColorsU32[idx];
    }
 
    static ImVec2 worldToPos(const vec_t& worldPos, const matrix_t& mat, ImVec2 position = ImVec2(gContext.mX, gContext.mY), ImVec2 size = ImVec2(gContext.mWidth, gContext.mHeight))
@@ -820,18 +1565,96 @@ namespace IMGUIZMO_NAMESPACE
       return ImVec2(trans.x, trans.y);
    }
 
-   static void ComputeCameraRay(vec_t& rayOrigin, vec_t& rayDir, ImVec2 position = ImVec2(gContext.mX, gContext.mY), ImVec2 size = ImVec2(gContext.mWidth, gContext.mHeight))
+#if defined(IMGUIZMO_SIMD)
+   // clip space x, y, w of 4 points to screen space, same operations as worldToPos
+   static inline void SimdClipToScreen(simd4f x, simd4f y, simd4f w, simd4f positionX, simd4f positionY, simd4f sizeX, simd4f sizeY, ImVec2* screenPos)
    {
-      ImGuiIO& io = ImGui::GetIO();
+      const simd4f half = SimdSplat(0.5f);
+      const simd4f scale = SimdDiv(half, w);
+      const simd4f screenX = SimdAdd(SimdMul(SimdAdd(SimdMul(x, scale), half), sizeX), positionX);
+      const simd4f screenY = SimdAdd(SimdMul(SimdSub(SimdSplat(1.f), SimdAdd(SimdMul(y, scale), half)), sizeY), positionY);
+      SimdStore(&screenPos[0].x, SimdZipLo(screenX, screenY));
+      SimdStore(&screenPos[2].x, SimdZipHi(screenX, screenY));
+   }
+#endif
+
+   // batch worldToPos for points stored as separate x, y and z arrays. clipW (optional) gets the clip space w of every
+   // point: points with w <= 0 are behind a perspective camera and their screen position is mirrored
+   static void worldToPos(const float* x, const float* y, const float* z, int count, const matrix_t& mat, ImVec2* screenPos, float* clipW = nullptr, ImVec2 position = ImVec2(gContext.mX, gContext.mY), ImVec2 size = ImVec2(gContext.mWidth, gContext.mHeight))
+   {
+      int i = 0;
+#if defined(IMGUIZMO_SIMD)
+      const simd4f m00 = SimdSplat(mat.m[0][0]), m01 = SimdSplat(mat.m[0][1]), m03 = SimdSplat(mat.m[0][3]);
+      const simd4f m10 = SimdSplat(mat.m[1][0]), m11 = SimdSplat(mat.m[1][1]), m13 = SimdSplat(mat.m[1][3]);
+      const simd4f m20 = SimdSplat(mat.m[2][0]), m21 = SimdSplat(mat.m[2][1]), m23 = SimdSplat(mat.m[2][3]);
+      const simd4f m30 = SimdSplat(mat.m[3][0]), m31 = SimdSplat(mat.m[3][1]), m33 = SimdSplat(mat.m[3][3]);
+      const simd4f positionX = SimdSplat(position.x), positionY = SimdSplat(position.y);
+      const simd4f sizeX = SimdSplat(size.x), sizeY = SimdSplat(size.y);
+      for (; i + 4 <= count; i += 4)
+      {
+         const simd4f px = SimdLoad(x + i);
+         const simd4f py = SimdLoad(y + i);
+         const simd4f pz = SimdLoad(z + i);
+         const simd4f clipX = SimdAdd(SimdMulAdd(pz, m20, SimdMulAdd(py, m10, SimdMul(px, m00))), m30);
+         const simd4f clipY = SimdAdd(SimdMulAdd(pz, m21, SimdMulAdd(py, m11, SimdMul(px, m01))), m31);
+         const simd4f clipW4 = SimdAdd(SimdMulAdd(pz, m23, SimdMulAdd(py, m13, SimdMul(px, m03))), m33);
+         SimdClipToScreen(clipX, clipY, clipW4, positionX, positionY, sizeX, sizeY, screenPos + i);
+         if (clipW)
+         {
+            SimdStore(clipW + i, clipW4);
+         }
+      }
+#endif
+      for (; i < count; i++)
+      {
+         screenPos[i] = worldToPos(makeVect(x[i], y[i], z[i]), mat, position, size);
+         if (clipW)
+         {
+            clipW[i] = x[i] * mat.m[0][3] + y[i] * mat.m[1][3] + z[i] * mat.m[2][3] + mat.m[3][3];
+         }
+      }
+   }
 
-      matrix_t mViewProjInverse;
-      mViewProjInverse.Inverse(gContext.mViewMat * gContext.mProjectionMat);
+   // batch worldToPos for an array of points
+   static void worldToPos(const vec_t* worldPos, int count, const matrix_t& mat, ImVec2* screenPos, ImVec2 position = ImVec2(gContext.mX, gContext.mY), ImVec2 size = ImVec2(gContext.mWidth, gContext.mHeight))
+   {
+      int i = 0;
+#if defined(IMGUIZMO_SIMD)
+      const simd4f row0 = SimdLoad(mat.m16);
+      const simd4f row1 = SimdLoad(mat.m16 + 4);
+      const simd4f row2 = SimdLoad(mat.m16 + 8);
+      const simd4f row3 = SimdLoad(mat.m16 + 12);
+      const simd4f positionX = SimdSplat(position.x), positionY = SimdSplat(position.y);
+      const simd4f sizeX = SimdSplat(size.x), sizeY = SimdSplat(size.y);
+      for (; i + 4 <= count; i += 4)
+      {
+         const simd4f p0 = SimdTransformPoint(SimdLoad(&worldPos[i].x), row0, row1, row2, row3);
+         const simd4f p1 = SimdTransformPoint(SimdLoad(&worldPos[i + 1].x), row0, row1, row2, row3);
+         const simd4f p2 = SimdTransformPoint(SimdLoad(&worldPos[i + 2].x), row0, row1, row2, row3);
+         const simd4f p3 = SimdTransformPoint(SimdLoad(&worldPos[i + 3].x), row0, row1, row2, row3);
+         // transpose to x, y, w lanes
+         const simd4f xy01 = IMGUIZMO_SIMD_SHUFFLE(p0, p1, 0, 1, 0, 1);
+         const simd4f xy23 = IMGUIZMO_SIMD_SHUFFLE(p2, p3, 0, 1, 0, 1);
+         const simd4f zw01 = IMGUIZMO_SIMD_SHUFFLE(p0, p1, 2, 3, 2, 3);
+         const simd4f zw23 = IMGUIZMO_SIMD_SHUFFLE(p2, p3, 2, 3, 2, 3);
+         SimdClipToScreen(IMGUIZMO_SIMD_SHUFFLE(xy01, xy23, 0, 2, 0, 2), IMGUIZMO_SIMD_SHUFFLE(xy01, xy23, 1, 3, 1, 3), IMGUIZMO_SIMD_SHUFFLE(zw01, zw23, 1, 3, 1, 3),
+            positionX, positionY, sizeX, sizeY, screenPos + i);
+      }
+#endif
+      for (; i < count; i++)
+      {
+         screenPos[i] = worldToPos(worldPos[i], mat, position, size);
+      }
+   }
 
-      const float mox = ((io.MousePos.x - position.x) / size.x) * 2.f - 1.f;
-      const float moy = (1.f - ((io.MousePos.y - position.y) / size.y)) * 2.f - 1.f;
+   // ray through screenPos, starting on the projection plane at depth 0 (or 1 when reversed)
+   static void ComputeScreenRay(vec_t& rayOrigin, vec_t& rayDir, const matrix_t& mViewProjInverse, bool reversed, ImVec2 screenPos, ImVec2 position, ImVec2 size)
+   {
+      const float mox = ((screenPos.x - position.x) / size.x) * 2.f - 1.f;
+      const float moy = (1.f - ((screenPos.y - position.y) / size.y)) * 2.f - 1.f;
 
-      const float zNear = gContext.mReversed ? (1.f - FLT_EPSILON) : 0.f;
-      const float zFar = gContext.mReversed ? 0.f : (1.f - FLT_EPSILON);
+      const float zNear = reversed ? (1.f - FLT_EPSILON) : 0.f;
+      const float zFar = reversed ? 0.f : (1.f - FLT_EPSILON);
 
       rayOrigin.Transform(makeVect(mox, moy, zNear, 1.f), mViewProjInverse);
       rayOrigin *= 1.f / rayOrigin.w;
@@ -841,6 +1664,11 @@ namespace IMGUIZMO_NAMESPACE
       rayDir = Normalized(rayEnd - rayOrigin);
    }
 
+   static void ComputeCameraRay(vec_t& rayOrigin, vec_t& rayDir, const matrix_t& mViewProjInverse, bool reversed, ImVec2 position = ImVec2(gContext.mX, gContext.mY), ImVec2 size = ImVec2(gContext.mWidth, gContext.mHeight))
+   {
+      ComputeScreenRay(rayOrigin, rayDir, mViewProjInverse, reversed, ImGui::GetIO().MousePos, position, size);
+   }
+
    static float GetSegmentLengthClipSpace(const vec_t& start, const vec_t& end, const bool localCoordinates = false)
    {
       vec_t startOfSegment = start;
@@ -934,16 +1762,36 @@ namespace IMGUIZMO_NAMESPACE
       return IsWithin(p.x, gContext.mX, gContext.mXMax) && IsWithin(p.y, gContext.mY, gContext.mYMax);
    }
 
+   static void InvalidateDrawListWindow()
+   {
+      gContext.mDrawListWindowSource = NULL;
+      gContext.mDrawListWindow = NULL;
+   }
+
+   // window owning the current draw list, looked up by name once per draw list.
+   // NULL for the foreground/background draw lists, which have no owner window.
+   static ImGuiWindow* GetDrawListWindow()
+   {
+      if (gContext.mDrawListWindowSource != gContext.mDrawList)
+      {
+         gContext.mDrawListWindow = ImGui::FindWindowByName(gContext.mDrawList->_OwnerName);
+         gContext.mDrawListWindowSource = gContext.mDrawList;
+      }
+      return gContext.mDrawListWindow;
+   }
+
    static bool IsHoveringWindow()
    {
       ImGuiContext& g = *ImGui::GetCurrentContext();
-      ImGuiWindow* window = ImGui::FindWindowByName(gContext.mDrawList->_OwnerName);
-      if (g.HoveredWindow == window)   // Mouse hovering drawlist window
+      ImGuiWindow* window = GetDrawListWindow();
+      if (window != NULL && g.HoveredWindow == window)   // Mouse hovering drawlist window
          return true;
       if (gContext.mAlternativeWindow != nullptr && g.HoveredWindow == gContext.mAlternativeWindow)
          return true;
       if (g.HoveredWindow != NULL)     // Any other window is hovered
          return false;
+      if (window == NULL)              // Foreground/background drawlist covers the whole display
+         return true;
       if (ImGui::IsMouseHoveringRect(window->InnerRect.Min, window->InnerRect.Max, false))   // Hovering drawlist window rect, while no other window is hovered (for _NoInputs windows)
          return true;
       return false;
@@ -958,6 +1806,7 @@ namespace IMGUIZMO_NAMESPACE
       gContext.mXMax = gContext.mX + gContext.mWidth;
       gContext.mYMax = gContext.mY + gContext.mXMax;
       gContext.mDisplayRatio = width / height;
+      InvalidateTripodCache();
    }
 
    void SetOrthographic(bool isOrthographic)
@@ -968,14 +1817,25 @@ namespace IMGUIZMO_NAMESPACE
    void SetDrawlist(ImDrawList* drawlist)
    {
       gContext.mDrawList = drawlist ? drawlist : ImGui::GetWindowDrawList();
+      gContext.mDrawListFrameCount = ImGui::GetFrameCount();
+      InvalidateDrawListWindow();
    }
 
    void SetImGuiContext(ImGuiContext* ctx)
    {
+      if (ImGui::GetCurrentContext() != ctx)
+      {
+         // frame counts and drawlists of the previous context mean nothing in the new one
+         gContext.mDrawList = NULL;
+         gContext.mFrameCount = -1;
+         gContext.mDrawListFrameCount = -1;
+      }
       ImGui::SetCurrentContext(ctx);
+      InvalidateDrawListWindow();
    }
 
-   void BeginFrame()
+   // full display, input-less window that the gizmos draw into when no drawlist was set for the frame
+   static void BeginGizmoWindow()
    {
       const ImU32 flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoBringToFrontOnFocus;
 
@@ -994,10 +1854,39 @@ namespace IMGUIZMO_NAMESPACE
 
       ImGui::Begin("gizmo", NULL, flags);
       gContext.mDrawList = ImGui::GetWindowDrawList();
+      InvalidateDrawListWindow();
+      ImGui::End();
+      ImGui::PopStyleVar();
+      ImGui::PopStyleColor(2);
+   }
+
+   static void EnsureDrawList()
+   {
+      if (gContext.mDrawList == NULL)
+      {
+         BeginGizmoWindow();
+      }
+   }
+
+   void BeginFrame()
+   {
+      // only the first call of an ImGui frame does anything
+      const int frameCount = ImGui::GetFrameCount();
+      if (frameCount == gContext.mFrameCount)
+      {
+         return;
+      }
+      gContext.mFrameCount = frameCount;
+
+      // a drawlist set earlier in this frame is kept, otherwise the gizmo window is created on first draw
+      if (gContext.mDrawListFrameCount != frameCount)
+      {
+         gContext.mDrawList = NULL;
+         InvalidateDrawListWindow();
+      }
       gContext.mbOverGizmoHotspot = false;
-      ImGui::End();
-      ImGui::PopStyleVar();
-      ImGui::PopStyleColor(2);
+      // catch style edits made through a reference kept from an earlier GetStyle(), a compare unless the colors changed
+      gContext.mStyleVersion++;
    }
 
    bool IsUsing()
@@ -1053,11 +1942,123 @@ namespace IMGUIZMO_NAMESPACE
       }
    }
 
+   void SetCamera(const float* view, const float* projection)
+   {
+      gContext.mCamera.Update(*(matrix_t*)view, *(matrix_t*)projection);
+   }
+
+   bool HasCamera()
+   {
+      return gContext.mCamera.mValid;
+   }
+
+   // ray through a screen position for picking: pointing away from the viewer, starting in front of everything visible
+   static void ComputePickingRay(const ViewProjectionCache& camera, ImVec2 screenPos, vec_t& origin, vec_t& dir)
+   {
+      ComputeScreenRay(origin, dir, camera.mViewProjectionInverse, camera.mReversed, screenPos, ImVec2(gContext.mX, gContext.mY), ImVec2(gContext.mWidth, gContext.mHeight));
+
+      // mReversed is tested on +z, behind a right-handed camera, so the gizmo ray can point back at the viewer.
+      // Picking needs it to point away: -z in view space, +z when the projection puts w < 0 there (left-handed)
+      vec_t probe;
+      probe.Transform(makeVect(0.f, 0.f, -1.f, 1.f), camera.mProjection);
+      vec_t forward = camera.mViewInverse.v.dir * (probe.w < 0.f ? 1.f : -1.f);
+      if (dir.Dot3(forward) < 0.f)
+      {
+         dir *= -1.f;
+      }
+      if (!gContext.mIsOrthographic)
+      {
+         // every perspective ray goes through the eye, start there so nothing in front of the camera is skipped
+         origin = camera.mViewInverse.v.position;
+      }
+      else
+      {
+         // start on the nearer of the depth -1 and 1 planes, which encloses the clip range whatever the depth convention
+         const float mox = ((screenPos.x - gContext.mX) / gContext.mWidth) * 2.f - 1.f;
+         const float moy = (1.f - ((screenPos.y - gContext.mY) / gContext.mHeight)) * 2.f - 1.f;
+         vec_t planeA, planeB;
+         planeA.Transform(makeVect(mox, moy, -1.f, 1.f), camera.mViewProjectionInverse);
+         planeA *= 1.f / planeA.w;
+         planeB.Transform(makeVect(mox, moy, 1.f, 1.f), camera.mViewProjectionInverse);
+         planeB *= 1.f / planeB.w;
+         origin = (planeA - planeB).Dot3(dir) < 0.f ? planeA : planeB;
+      }
+   }
+
+   void ComputeRay(ImVec2 screenPos, float* rayOrigin, float* rayDirection)
+   {
+      IM_ASSERT(gContext.mCamera.mValid); // SetCamera was never called
+      vec_t origin, dir;
+      ComputePickingRay(gContext.mCamera, screenPos, origin, dir);
+      rayOrigin[0] = origin.x;
+      rayOrigin[1] = origin.y;
+      rayOrigin[2] = origin.z;
+      rayDirection[0] = dir.x;
+      rayDirection[1] = dir.y;
+      rayDirection[2] = dir.z;
+   }
+
+   // view-dependent data for a call, NULL view or projection stand for the ones given to SetCamera
+   static const ViewProjectionCache& GetCamera(const float* view, const float* projection)
+   {
+      IM_ASSERT((view && projection) || gContext.mCamera.mValid); // SetCamera was never called
+      if (!view && !projection)
+      {
+         return gContext.mCamera;
+      }
+      gContext.mViewProjectionCache.Update(view ? *(matrix_t*)view : gContext.mCamera.mView, projection ? *(matrix_t*)projection : gContext.mCamera.mProjection);
+      return gContext.mViewProjectionCache;
+   }
+
+   // screen circle around a world sphere, from its tangent planes x = t * w and y = t * w in clip space. Exact for
+   // perspective and orthographic projections, unbounded when the sphere crosses w = 0
+   static void ComputeHitBounds(const vec_t& center, float radius, float pixelMargin)
+   {
+      const float* m = gContext.mViewProjection.m16;
+      const float radiusSq = radius * radius;
+      const float centerW = center.x * m[3] + center.y * m[7] + center.z * m[11] + m[15];
+      const float lengthSqW = m[3] * m[3] + m[7] * m[7] + m[11] * m[11];
+      const float a = centerW * centerW - radiusSq * lengthSqW;
+      if (!(a > FLT_EPSILON * centerW * centerW))
+      {
+         gContext.mHitBoundsRadiusSq = FLT_MAX;
+         return;
+      }
+      float ndcMin[2], ndcMax[2];
+      for (int i = 0; i < 2; i++)
+      {
+         const float centerI = center.x * m[i] + center.y * m[4 + i] + center.z * m[8 + i] + m[12 + i];
+         const float b = centerI * centerW - radiusSq * (m[i] * m[3] + m[4 + i] * m[7] + m[8 + i] * m[11]);
+         const float c = centerI * centerI - radiusSq * (m[i] * m[i] + m[4 + i] * m[4 + i] + m[8 + i] * m[8 + i]);
+         const float root = sqrtf(ImMax(b * b - a * c, 0.f));
+         ndcMin[i] = (b - root) / a;
+         ndcMax[i] = (b + root) / a;
+      }
+      const float halfWidth = (ndcMax[0] - ndcMin[0]) * 0.25f * gContext.mWidth;
+      const float halfHeight = (ndcMax[1] - ndcMin[1]) * 0.25f * gContext.mHeight;
+      gContext.mHitBoundsCenter = ImVec2(gContext.mX + ((ndcMin[0] + ndcMax[0]) * 0.25f + 0.5f) * gContext.mWidth,
+         gContext.mY + (0.5f - (ndcMin[1] + ndcMax[1]) * 0.25f) * gContext.mHeight);
+      const float boundsRadius = sqrtf(halfWidth * halfWidth + halfHeight * halfHeight) + pixelMargin;
+      gContext.mHitBoundsRadiusSq = boundsRadius * boundsRadius;
+   }
+
+   // false when the mouse is away from the gizmo footprint and from a screen space part of screenRadius around its origin
+   static bool IsMouseNearGizmo(float screenRadius)
+   {
+      const ImVec2 mousePos = ImGui::GetIO().MousePos;
+      return !(ImLengthSqr(mousePos - gContext.mHitBoundsCenter) > gContext.mHitBoundsRadiusSq) ||
+         ImLengthSqr(mousePos - gContext.mScreenSquareCenter) <= screenRadius * screenRadius;
+   }
+
    static void ComputeContext(const float* view, const float* projection, float* matrix, MODE mode)
    {
+      InvalidateTripodCache();
+      gContext.mRotationCirclesValid = false;
       gContext.mMode = mode;
-      gContext.mViewMat = *(matrix_t*)view;
-      gContext.mProjectionMat = *(matrix_t*)projection;
+      const ViewProjectionCache& camera = GetCamera(view, projection);
+      gContext.mCallCamera = &camera;
+      gContext.mViewMat = camera.mView;
+      gContext.mProjectionMat = camera.mProjection;
       gContext.mbMouseOver = IsHoveringWindow();
 
       gContext.mModelLocal = *(matrix_t*)matrix;
@@ -1074,25 +2075,18 @@ namespace IMGUIZMO_NAMESPACE
       gContext.mModelSource = *(matrix_t*)matrix;
       gContext.mModelScaleOrigin.Set(gContext.mModelSource.v.right.Length(), gContext.mModelSource.v.up.Length(), gContext.mModelSource.v.dir.Length());
 
-      gContext.mModelInverse.Inverse(gContext.mModel);
-      gContext.mModelSourceInverse.Inverse(gContext.mModelSource);
-      gContext.mViewProjection = gContext.mViewMat * gContext.mProjectionMat;
+      gContext.mModelInverse.InverseClassified(gContext.mModel);
+      gContext.mModelSourceInverse.InverseClassified(gContext.mModelSource);
+      gContext.mViewProjection = camera.mViewProjection;
       gContext.mMVP = gContext.mModel * gContext.mViewProjection;
       gContext.mMVPLocal = gContext.mModelLocal * gContext.mViewProjection;
 
-      matrix_t viewInverse;
-      viewInverse.Inverse(gContext.mViewMat);
+      const matrix_t& viewInverse = camera.mViewInverse;
       gContext.mCameraDir = viewInverse.v.dir;
       gContext.mCameraEye = viewInverse.v.position;
       gContext.mCameraRight = viewInverse.v.right;
       gContext.mCameraUp = viewInverse.v.up;
-
-      // projection reverse
-       vec_t nearPos, farPos;
-       nearPos.Transform(makeVect(0, 0, 1.f, 1.f), gContext.mProjectionMat);
-       farPos.Transform(makeVect(0, 0, 2.f, 1.f), gContext.mProjectionMat);
-
-       gContext.mReversed = (nearPos.z/nearPos.w) > (farPos.z / farPos.w);
+      gContext.mReversed = camera.mReversed;
 
       // compute scale from the size of camera right vector projected on screen at the matrix position
       vec_t pointRight = viewInverse.v.right;
@@ -1109,7 +2103,11 @@ namespace IMGUIZMO_NAMESPACE
       gContext.mScreenSquareMin = ImVec2(centerSSpace.x - 10.f, centerSSpace.y - 10.f);
       gContext.mScreenSquareMax = ImVec2(centerSSpace.x + 10.f, centerSSpace.y + 10.f);
 
-      ComputeCameraRay(gContext.mRayOrigin, gContext.mRayVector);
+      ComputeCameraRay(gContext.mRayOrigin, gContext.mRayVector, camera.mViewProjectionInverse, gContext.mReversed);
+
+      // every hit test stays within 1.6 screen factors of the origin (a plane quad corner on skewed axes, scale axes
+      // end at 1.4), and within 12 pixels of what it projects to
+      ComputeHitBounds(gContext.mModel.v.position, gContext.mScreenFactor * quadMax * 2.f, 12.f);
    }
 
    static void ComputeColors(ImU32* colors, int type, OPERATION operation)
@@ -1179,37 +2177,55 @@ namespace IMGUIZMO_NAMESPACE
       }
       else
       {
-         // new method
-         float lenDir = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirAxis, localCoordinates);
-         float lenDirMinus = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), -dirAxis, localCoordinates);
-
-         float lenDirPlaneX = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirPlaneX, localCoordinates);
-         float lenDirMinusPlaneX = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), -dirPlaneX, localCoordinates);
-
-         float lenDirPlaneY = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirPlaneY, localCoordinates);
-         float lenDirMinusPlaneY = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), -dirPlaneY, localCoordinates);
-
-         // For readability
-         bool & allowFlip = gContext.mAllowAxisFlip;
-         float mulAxis = (allowFlip && lenDir < lenDirMinus&& fabsf(lenDir - lenDirMinus) > FLT_EPSILON) ? -1.f : 1.f;
-         float mulAxisX = (allowFlip && lenDirPlaneX < lenDirMinusPlaneX&& fabsf(lenDirPlaneX - lenDirMinusPlaneX) > FLT_EPSILON) ? -1.f : 1.f;
-         float mulAxisY = (allowFlip && lenDirPlaneY < lenDirMinusPlaneY&& fabsf(lenDirPlaneY - lenDirMinusPlaneY) > FLT_EPSILON) ? -1.f : 1.f;
-         dirAxis *= mulAxis;
-         dirPlaneX *= mulAxisX;
-         dirPlaneY *= mulAxisY;
-
-         // for axis
-         float axisLengthInClipSpace = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirAxis * gContext.mScreenFactor, localCoordinates);
+         Context::TripodCache& cache = gContext.mTripodCache[localCoordinates ? 1 : 0][axisIndex];
+         if (!cache.mValid)
+         {
+            // new method
+            float lenDir = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirAxis, localCoordinates);
+            float lenDirMinus = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), -dirAxis, localCoordinates);
+
+            float lenDirPlaneX = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirPlaneX, localCoordinates);
+            float lenDirMinusPlaneX = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), -dirPlaneX, localCoordinates);
+
+            float lenDirPlaneY = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirPlaneY, localCoordinates);
+            float lenDirMinusPlaneY = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), -dirPlaneY, localCoordinates);
+
+            // For readability
+            bool & allowFlip = gContext.mAllowAxisFlip;
+            float mulAxis = (allowFlip && lenDir < lenDirMinus&& fabsf(lenDir - lenDirMinus) > FLT_EPSILON) ? -1.f : 1.f;
+            float mulAxisX = (allowFlip && lenDirPlaneX < lenDirMinusPlaneX&& fabsf(lenDirPlaneX - lenDirMinusPlaneX) > FLT_EPSILON) ? -1.f : 1.f;
+            float mulAxisY = (allowFlip && lenDirPlaneY < lenDirMinusPlaneY&& fabsf(lenDirPlaneY - lenDirMinusPlaneY) > FLT_EPSILON) ? -1.f : 1.f;
+            dirAxis *= mulAxis;
+            dirPlaneX *= mulAxisX;
+            dirPlaneY *= mulAxisY;
+
+            // for axis
+            float axisLengthInClipSpace = GetSegmentLengthClipSpace(makeVect(0.f, 0.f, 0.f), dirAxis * gContext.mScreenFactor, localCoordinates);
+
+            float paraSurf = GetParallelogram(makeVect(0.f, 0.f, 0.f), dirPlaneX * gContext.mScreenFactor, dirPlaneY * gContext.mScreenFactor);
+            // Apply axis mask to axes and planes
+            cache.mBelowPlaneLimit = (paraSurf > gContext.mAxisLimit) && (((1<<axisIndex)&gContext.mAxisMask) && !(gContext.mAxisMask & (gContext.mAxisMask - 1)) || !gContext.mAxisMask);
+            cache.mBelowAxisLimit = (axisLengthInClipSpace > gContext.mPlaneLimit) && !((1<<axisIndex)&gContext.mAxisMask);
+
+            cache.mDirAxis = dirAxis;
+            cache.mDirPlaneX = dirPlaneX;
+            cache.mDirPlaneY = dirPlaneY;
+            cache.mAxisFactor[0] = mulAxis;
+            cache.mAxisFactor[1] = mulAxisX;
+            cache.mAxisFactor[2] = mulAxisY;
+            cache.mValid = true;
+         }
 
-         float paraSurf = GetParallelogram(makeVect(0.f, 0.f, 0.f), dirPlaneX * gContext.mScreenFactor, dirPlaneY * gContext.mScreenFactor);
-         // Apply axis mask to axes and planes
-         belowPlaneLimit = (paraSurf > gContext.mAxisLimit) && (((1<<axisIndex)&gContext.mAxisMask) && !(gContext.mAxisMask & (gContext.mAxisMask - 1)) || !gContext.mAxisMask);
-         belowAxisLimit = (axisLengthInClipSpace > gContext.mPlaneLimit) && !((1<<axisIndex)&gContext.mAxisMask);
+         dirAxis = cache.mDirAxis;
+         dirPlaneX = cache.mDirPlaneX;
+         dirPlaneY = cache.mDirPlaneY;
+         belowAxisLimit = cache.mBelowAxisLimit;
+         belowPlaneLimit = cache.mBelowPlaneLimit;
 
          // and store values
-         gContext.mAxisFactor[axisIndex] = mulAxis;
-         gContext.mAxisFactor[(axisIndex + 1) % 3] = mulAxisX;
-         gContext.mAxisFactor[(axisIndex + 2) % 3] = mulAxisY;
+         gContext.mAxisFactor[axisIndex] = cache.mAxisFactor[0];
+         gContext.mAxisFactor[(axisIndex + 1) % 3] = cache.mAxisFactor[1];
+         gContext.mAxisFactor[(axisIndex + 2) % 3] = cache.mAxisFactor[2];
          gContext.mBelowAxisLimit[axisIndex] = belowAxisLimit;
          gContext.mBelowPlaneLimit[axisIndex] = belowPlaneLimit;
       }
@@ -1255,35 +2271,95 @@ namespace IMGUIZMO_NAMESPACE
       return angle;
    }
 
-   static void DrawRotationGizmo(OPERATION op, int type)
+   // smallest power of two segment count per half circle, down to minHalfCircleSegmentCount, whose chords
+   // stay within CircleTessellationMaxError pixels of a circle with this screen radius
+   static int ComputeHalfCircleSegmentCount(float radius)
    {
-      if(!Intersects(op, ROTATE))
+      const float maxError = gContext.mStyle.CircleTessellationMaxError;
+      int segmentCount = halfCircleSegmentCount;
+      if (maxError <= 0.f)
       {
-         return;
+         return segmentCount;
       }
-      ImDrawList* drawList = gContext.mDrawList;
+      // sagitta of a chord spanning PI / (segmentCount / 2) is radius * (1 - cos(PI / segmentCount))
+      while (segmentCount > minHalfCircleSegmentCount && radius * (1.f - unitCircle.mCos[halfCircleSegmentCount / segmentCount]) <= maxError)
+      {
+         segmentCount /= 2;
+      }
+      return segmentCount;
+   }
 
-      bool isMultipleAxesMasked = gContext.mAxisMask & (gContext.mAxisMask - 1);
-      bool isNoAxesMasked = !gContext.mAxisMask;
+   // distance from the center to a closed regular polygon inscribed in a unit circle, in the direction
+   // making angle with its first vertex
+   static float PolygonRadius(int segmentCount, float angle)
+   {
+      const float step = 2.f * ZPI / (float)segmentCount;
+      float local = fmodf(angle, step);
+      if (local < 0.f)
+      {
+         local += step;
+      }
+      return cosf(step * 0.5f) / cosf(local - step * 0.5f);
+   }
 
-      // colors
-      ImU32 colors[7];
-      ComputeColors(colors, type, ROTATE);
+   static const Context::RotationCircle* GetRotationCircles()
+   {
+      if (gContext.mRotationCirclesValid)
+      {
+         return gContext.mRotationCircles;
+      }
 
       vec_t cameraToModelNormalized;
       if (gContext.mIsOrthographic)
       {
-         matrix_t viewInverse;
-         viewInverse.Inverse(*(matrix_t*)&gContext.mViewMat);
-         cameraToModelNormalized = -viewInverse.v.dir;
+         cameraToModelNormalized = -gContext.mCameraDir;
       }
       else
       {
          cameraToModelNormalized = Normalized(gContext.mModel.v.position - gContext.mCameraEye);
       }
-
       cameraToModelNormalized.TransformVector(gContext.mModelInverse);
 
+      // screen length of each model axis at circle radius; their quadratic sum bounds the projected circle radius
+      const float radius = gContext.mScreenFactor * rotationDisplayFactor;
+      const float axisX[4] = { 0.f, radius, 0.f, 0.f };
+      const float axisY[4] = { 0.f, 0.f, radius, 0.f };
+      const float axisZ[4] = { 0.f, 0.f, 0.f, radius };
+      ImVec2 axisScreen[4];
+      worldToPos(axisX, axisY, axisZ, 4, gContext.mMVP, axisScreen);
+      float axisLengthSq[3];
+      for (int i = 0; i < 3; i++)
+      {
+         axisLengthSq[i] = ImLengthSqr(axisScreen[i + 1] - axisScreen[0]);
+      }
+
+      for (int axis = 0; axis < 3; axis++)
+      {
+         Context::RotationCircle& circle = gContext.mRotationCircles[axis];
+         circle.mAngleStart = atan2f(cameraToModelNormalized[(4 - axis) % 3], cameraToModelNormalized[(3 - axis) % 3]) + ZPI * 0.5f;
+         circle.mSegmentCount = ComputeHalfCircleSegmentCount(sqrtf(axisLengthSq[(3 - axis) % 3] + axisLengthSq[(4 - axis) % 3]));
+      }
+      gContext.mRotationCirclesValid = true;
+      return gContext.mRotationCircles;
+   }
+
+   static void DrawRotationGizmo(OPERATION op, int type)
+   {
+      if(!Intersects(op, ROTATE))
+      {
+         return;
+      }
+      ImDrawList* drawList = gContext.mDrawList;
+
+      bool isMultipleAxesMasked = gContext.mAxisMask & (gContext.mAxisMask - 1);
+      bool isNoAxesMasked = !gContext.mAxisMask;
+
+      // colors
+      ImU32 colors[7];
+      ComputeColors(colors, type, ROTATE);
+
+      const Context::RotationCircle* circles = GetRotationCircles();
+
       gContext.mRadiusSquareCenter = screenRotateSize * gContext.mHeight;
 
       bool hasRSC = Intersects(op, ROTATE_SCREEN);
@@ -1303,20 +2379,33 @@ namespace IMGUIZMO_NAMESPACE
          const bool usingAxis = (gContext.mbUsing && type == MT_ROTATE_Z - axis);
          const int circleMul = (hasRSC && !usingAxis) ? 1 : 2;
 
-         ImVec2* circlePos = (ImVec2*)alloca(sizeof(ImVec2) * (circleMul * halfCircleSegmentCount + 1));
-
-         float angleStart = atan2f(cameraToModelNormalized[(4 - axis) % 3], cameraToModelNormalized[(3 - axis) % 3]) + ZPI * 0.5f;
-
-         for (int i = 0; i < circleMul * halfCircleSegmentCount + 1; i++)
+         const int segmentCount = circleMul * circles[axis].mSegmentCount;
+         const int tableStep = halfCircleSegmentCount / circles[axis].mSegmentCount;
+         ImVec2 circlePos[2 * halfCircleSegmentCount + 1];
+
+         // start direction once, then rotate the table steps by it
+         const float radius = gContext.mScreenFactor * rotationDisplayFactor;
+         const float cosStart = cosf(circles[axis].mAngleStart) * radius;
+         const float sinStart = sinf(circles[axis].mAngleStart) * radius;
+
+         // circle points in model space, one array per component so they project in one batch
+         float circleCoords[3][2 * halfCircleSegmentCount + 1];
+         const int pointCount = segmentCount + 1;
+         float* circleX = circleCoords[(3 - axis) % 3];
+         float* circleY = circleCoords[(4 - axis) % 3];
+         float* circleZ = circleCoords[(5 - axis) % 3];
+         for (int i = 0; i < pointCount; i++)
          {
-            float ng = angleStart + (float)circleMul * ZPI * ((float)i / (float)(circleMul * halfCircleSegmentCount));
-            vec_t axisPos = makeVect(cosf(ng), sinf(ng), 0.f);
-            vec_t pos = makeVect(axisPos[axis], axisPos[(axis + 1) % 3], axisPos[(axis + 2) % 3]) * gContext.mScreenFactor * rotationDisplayFactor;
-            circlePos[i] = worldToPos(pos, gContext.mMVP);
+            const float tableCos = unitCircle.mCos[i * tableStep];
+            const float tableSin = unitCircle.mSin[i * tableStep];
+            circleX[i] = cosStart * tableCos - sinStart * tableSin;
+            circleY[i] = sinStart * tableCos + cosStart * tableSin;
+            circleZ[i] = 0.f;
          }
+         worldToPos(circleCoords[0], circleCoords[1], circleCoords[2], pointCount, gContext.mMVP, circlePos);
          if (!gContext.mbUsing || usingAxis)
          {
-            drawList->AddPolyline(circlePos, circleMul* halfCircleSegmentCount + 1, colors[3 - axis], false, gContext.mStyle.RotationLineThickness);
+            drawList->AddPolyline(circlePos, pointCount, colors[3 - axis], false, gContext.mStyle.RotationLineThickness);
          }
 
          float radiusAxis = sqrtf((ImLengthSqr(worldToPos(gContext.mModel.v.position, gContext.mViewProjection) - circlePos[0])));
@@ -1325,28 +2414,58 @@ namespace IMGUIZMO_NAMESPACE
             gContext.mRadiusSquareCenter = radiusAxis;
          }
       }
+      // AddCircle takes a full circle count, capped at the former fixed 64 segments
+      gContext.mRadiusSquareSegmentCount = ImMin(2 * ComputeHalfCircleSegmentCount(gContext.mRadiusSquareCenter), 64);
       if(hasRSC && (!gContext.mbUsing || type == MT_ROTATE_SCREEN) && (!isMultipleAxesMasked && isNoAxesMasked))
       {
-         drawList->AddCircle(worldToPos(gContext.mModel.v.position, gContext.mViewProjection), gContext.mRadiusSquareCenter, colors[0], 64, gContext.mStyle.RotationOuterLineThickness);
+         drawList->AddCircle(worldToPos(gContext.mModel.v.position, gContext.mViewProjection), gContext.mRadiusSquareCenter, colors[0], gContext.mRadiusSquareSegmentCount, gContext.mStyle.RotationOuterLineThickness);
       }
 
       if (gContext.mbUsing && (gContext.GetCurrentID() == gContext.mEditingID) && IsRotateType(type))
       {
+         // an arc can span a full turn, so it gets the full circle count of the finest axis circle
+         int arcSegmentCount = circles[0].mSegmentCount;
+         arcSegmentCount = ImMax(arcSegmentCount, circles[1].mSegmentCount);
+         arcSegmentCount = ImMax(arcSegmentCount, circles[2].mSegmentCount);
+         arcSegmentCount = ImMin(2 * arcSegmentCount, (int)halfCircleSegmentCount);
          ImVec2 circlePos[halfCircleSegmentCount + 1];
-
-         circlePos[0] = worldToPos(gContext.mModel.v.position, gContext.mViewProjection);
-         for (unsigned int i = 1; i < halfCircleSegmentCount + 1; i++)
+         vec_t arcPos[halfCircleSegmentCount + 1];
+
+         // rotate the source vector around the plan normal: rot = p + u * cos + w * sin,
+         // with p the part along the normal, u the part across it and w = normal x source.
+         // (cos, sin) advance by a fixed step so only one sinf/cosf pair is needed.
+         const vec_t& source = gContext.mRotationVectorSource;
+         vec_t normal = makeVect(0.f, 0.f, 0.f);
+         float stepCos = 1.f;
+         float stepSin = 0.f;
+         const float normalLengthSq = gContext.mTranslationPlan.LengthSq();
+         if (normalLengthSq >= FLT_EPSILON)
          {
-            float ng = gContext.mRotationAngle * ((float)(i - 1) / (float)(halfCircleSegmentCount - 1));
-            matrix_t rotateVectorMatrix;
-            rotateVectorMatrix.RotationAxis(gContext.mTranslationPlan, ng);
-            vec_t pos;
-            pos.TransformPoint(gContext.mRotationVectorSource, rotateVectorMatrix);
-            pos *= gContext.mScreenFactor * rotationDisplayFactor;
-            circlePos[i] = worldToPos(pos + gContext.mModel.v.position, gContext.mViewProjection);
+            normal = gContext.mTranslationPlan * (1.f / sqrtf(normalLengthSq));
+            normal.w = 0.f;
+            const float step = gContext.mRotationAngle / (float)(arcSegmentCount - 1);
+            stepCos = cosf(step);
+            stepSin = sinf(step);
          }
-         drawList->AddConvexPolyFilled(circlePos, halfCircleSegmentCount + 1, GetColorU32(ROTATION_USING_FILL));
-         drawList->AddPolyline(circlePos, halfCircleSegmentCount + 1, GetColorU32(ROTATION_USING_BORDER), true, gContext.mStyle.RotationLineThickness);
+         const float radius = gContext.mScreenFactor * rotationDisplayFactor;
+         const vec_t along = normal * normal.Dot3(source);
+         const vec_t across = (makeVect(source.x, source.y, source.z) - along) * radius;
+         const vec_t side = Cross(normal, source) * radius;
+         const vec_t center = along * radius + gContext.mModel.v.position;
+
+         arcPos[0] = gContext.mModel.v.position;
+         float c = 1.f;
+         float s = 0.f;
+         for (int i = 1; i < arcSegmentCount + 1; i++)
+         {
+            arcPos[i] = center + across * c + side * s;
+            const float nc = c * stepCos - s * stepSin;
+            s = s * stepCos + c * stepSin;
+            c = nc;
+         }
+         worldToPos(arcPos, arcSegmentCount + 1, gContext.mViewProjection, circlePos);
+         drawList->AddConvexPolyFilled(circlePos, arcSegmentCount + 1, GetColorU32(ROTATION_USING_FILL));
+         drawList->AddPolyline(circlePos, arcSegmentCount + 1, GetColorU32(ROTATION_USING_BORDER), true, gContext.mStyle.RotationLineThickness);
 
          ImVec2 destinationPosOnScreen = circlePos[1];
          char tmps[512];
@@ -1363,11 +2482,17 @@ namespace IMGUIZMO_NAMESPACE
          return;
       }
 
+      vec_t hatchPos[18];
       for (int j = 1; j < 10; j++)
       {
-         ImVec2 baseSSpace2 = worldToPos(axis * 0.05f * (float)(j * 2) * gContext.mScreenFactor, gContext.mMVP);
-         ImVec2 worldDirSSpace2 = worldToPos(axis * 0.05f * (float)(j * 2 + 1) * gContext.mScreenFactor, gContext.mMVP);
-         gContext.mDrawList->AddLine(baseSSpace2, worldDirSSpace2, GetColorU32(HATCHED_AXIS_LINES), gContext.mStyle.HatchedAxisLineThickness);
+         hatchPos[j * 2 - 2] = axis * 0.05f * (float)(j * 2) * gContext.mScreenFactor;
+         hatchPos[j * 2 - 1] = axis * 0.05f * (float)(j * 2 + 1) * gContext.mScreenFactor;
+      }
+      ImVec2 hatchSSpace[18];
+      worldToPos(hatchPos, 18, gContext.mMVP, hatchSSpace);
+      for (int j = 0; j < 9; j++)
+      {
+         gContext.mDrawList->AddLine(hatchSSpace[j * 2], hatchSSpace[j * 2 + 1], GetColorU32(HATCHED_AXIS_LINES), gContext.mStyle.HatchedAxisLineThickness);
       }
    }
 
@@ -1912,9 +3037,10 @@ namespace IMGUIZMO_NAMESPACE
    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
    //
 
-   static int GetScaleType(OPERATION op)
+   static int ComputeScaleType(OPERATION op)
    {
-      if (gContext.mbUsing)
+      // screen square corners and the universal scale ring are within 23 pixels of the origin
+      if (gContext.mbUsing || !IsMouseNearGizmo(23.f))
       {
          return MT_NONE;
       }
@@ -2002,9 +3128,9 @@ namespace IMGUIZMO_NAMESPACE
       return type;
    }
 
-   static int GetRotateType(OPERATION op)
+   static int ComputeRotateType(OPERATION op)
    {
-      if (gContext.mbUsing)
+      if (gContext.mbUsing || !IsMouseNearGizmo(Intersects(op, ROTATE_SCREEN) ? gContext.mRadiusSquareCenter + 4.f : 0.f))
       {
          return MT_NONE;
       }
@@ -2017,13 +3143,20 @@ namespace IMGUIZMO_NAMESPACE
 
       vec_t deltaScreen = { io.MousePos.x - gContext.mScreenSquareCenter.x, io.MousePos.y - gContext.mScreenSquareCenter.y, 0.f, 0.f };
       float dist = deltaScreen.Length();
-      if (Intersects(op, ROTATE_SCREEN) && dist >= (gContext.mRadiusSquareCenter - 4.0f) && dist < (gContext.mRadiusSquareCenter + 4.0f))
+      if (Intersects(op, ROTATE_SCREEN))
       {
-         if (!isNoAxesMasked)
-            return MT_NONE;
-         type = MT_ROTATE_SCREEN;
+         // test against the drawn polygon rather than the true circle
+         const float ringRadius = gContext.mRadiusSquareCenter * PolygonRadius(gContext.mRadiusSquareSegmentCount, atan2f(deltaScreen.y, deltaScreen.x));
+         if (dist >= (ringRadius - 4.0f) && dist < (ringRadius + 4.0f))
+         {
+            if (!isNoAxesMasked)
+               return MT_NONE;
+            type = MT_ROTATE_SCREEN;
+         }
       }
 
+      const Context::RotationCircle* circles = GetRotationCircles();
+
       const vec_t planNormals[] = { gContext.mModel.v.right, gContext.mModel.v.up, gContext.mModel.v.dir };
 
       vec_t modelViewPos;
@@ -2052,7 +3185,11 @@ namespace IMGUIZMO_NAMESPACE
          const vec_t localPos = intersectWorldPos - gContext.mModel.v.position;
          vec_t idealPosOnCircle = Normalized(localPos);
          idealPosOnCircle.TransformVector(gContext.mModelInverse);
-         const ImVec2 idealPosOnCircleScreen = worldToPos(idealPosOnCircle * rotationDisplayFactor * gContext.mScreenFactor, gContext.mMVP);
+         // move onto the drawn polygon edge so picking follows the tessellation
+         const Context::RotationCircle& circle = circles[2 - i];
+         const float angle = atan2f(idealPosOnCircle[(2 + i) % 3], idealPosOnCircle[(1 + i) % 3]) - circle.mAngleStart;
+         const float polygonRadius = PolygonRadius(2 * circle.mSegmentCount, angle);
+         const ImVec2 idealPosOnCircleScreen = worldToPos(idealPosOnCircle * (polygonRadius * rotationDisplayFactor * gContext.mScreenFactor), gContext.mMVP);
 
          //gContext.mDrawList->AddCircle(idealPosOnCircleScreen, 5.f, IM_COL32_WHITE);
          const ImVec2 distanceOnScreen = idealPosOnCircleScreen - io.MousePos;
@@ -2069,9 +3206,10 @@ namespace IMGUIZMO_NAMESPACE
       return type;
    }
 
-   static int GetMoveType(OPERATION op, vec_t* gizmoHitProportion)
+   static int ComputeMoveType(OPERATION op, vec_t* gizmoHitProportion)
    {
-      if(!Intersects(op, TRANSLATE) || gContext.mbUsing || !gContext.mbMouseOver)
+      // the screen square corners are 10 * sqrt(2) pixels from the origin
+      if(!Intersects(op, TRANSLATE) || gContext.mbUsing || !gContext.mbMouseOver || !IsMouseNearGizmo(15.f))
       {
         return MT_NONE;
       }
@@ -2134,6 +3272,70 @@ namespace IMGUIZMO_NAMESPACE
       return type;
    }
 
+   // the cached entry for a hit test, false when it has to run again and fill it
+   static bool FindHoverCache(int index, OPERATION op, Context::HoverCache*& cache)
+   {
+      cache = &gContext.mHoverCache[index];
+      const ImVec2 mousePos = ImGui::GetIO().MousePos;
+      if (cache->mValid && cache->mOperation == op && cache->mMousePos.x == mousePos.x && cache->mMousePos.y == mousePos.y &&
+         (index != Context::HOVER_ROTATE || cache->mRadiusSquareCenter == gContext.mRadiusSquareCenter))
+      {
+         return true;
+      }
+      cache->mValid = true;
+      cache->mOperation = op;
+      cache->mMousePos = mousePos;
+      cache->mRadiusSquareCenter = gContext.mRadiusSquareCenter;
+      return false;
+   }
+
+   static int GetMoveType(OPERATION op, vec_t* gizmoHitProportion)
+   {
+      if (gContext.mbUsing)
+      {
+         return MT_NONE;
+      }
+      Context::HoverCache* cache;
+      if (!FindHoverCache(Context::HOVER_MOVE, op, cache))
+      {
+         cache->mHitProportion = makeVect(0.f, 0.f, 0.f);
+         cache->mType = ComputeMoveType(op, &cache->mHitProportion);
+      }
+      if (gizmoHitProportion)
+      {
+         *gizmoHitProportion = cache->mHitProportion;
+      }
+      return cache->mType;
+   }
+
+   static int GetRotateType(OPERATION op)
+   {
+      if (gContext.mbUsing)
+      {
+         return MT_NONE;
+      }
+      Context::HoverCache* cache;
+      if (!FindHoverCache(Context::HOVER_ROTATE, op, cache))
+      {
+         cache->mType = ComputeRotateType(op);
+      }
+      return cache->mType;
+   }
+
+   static int GetScaleType(OPERATION op)
+   {
+      if (gContext.mbUsing)
+      {
+         return MT_NONE;
+      }
+      Context::HoverCache* cache;
+      if (!FindHoverCache(Context::HOVER_SCALE, op, cache))
+      {
+         cache->mType = ComputeScaleType(op);
+      }
+      return cache->mType;
+   }
+
    static bool HandleTranslation(float* matrix, float* deltaMatrix, OPERATION op, int& type, const float* snap)
    {
       if(!Intersects(op, TRANSLATE) || type != MT_NONE)
@@ -2178,7 +3380,7 @@ namespace IMGUIZMO_NAMESPACE
                matrix_t modelSourceNormalized = gContext.mModelSource;
                modelSourceNormalized.OrthoNormalize();
                matrix_t modelSourceNormalizedInverse;
-               modelSourceNormalizedInverse.Inverse(modelSourceNormalized);
+               modelSourceNormalizedInverse.InverseClassified(modelSourceNormalized);
                cumulativeDelta.TransformVector(modelSourceNormalizedInverse);
                ComputeSnap(cumulativeDelta, snap);
                cumulativeDelta.TransformVector(modelSourceNormalized);
@@ -2191,6 +3393,48 @@ namespace IMGUIZMO_NAMESPACE
 
          }
 
+         // snap hook, a snapped position is brought back on the dragged axis or plane, a surface position is not
+         vec_t surfaceNormal = makeVect(0.f, 0.f, 0.f);
+         if (gContext.mTranslationSnapCallback)
+         {
+            TranslationSnapQuery query;
+            const vec_t position = gContext.mModel.v.position + delta;
+            memcpy(query.position, &position.x, sizeof(query.position));
+            memcpy(query.viewProjection, gContext.mViewProjection.m16, sizeof(query.viewProjection));
+            query.rectPosition = ImVec2(gContext.mX, gContext.mY);
+            query.rectSize = ImVec2(gContext.mWidth, gContext.mHeight);
+            query.mousePos = io.MousePos;
+            vec_t rayOrigin, rayDirection;
+            ComputePickingRay(*gContext.mCallCamera, io.MousePos, rayOrigin, rayDirection);
+            memcpy(query.rayOrigin, &rayOrigin.x, sizeof(query.rayOrigin));
+            memcpy(query.rayDirection, &rayDirection.x, sizeof(query.rayDirection));
+            TranslationSnapResult result;
+            memset(&result, 0, sizeof(result));
+            if (gContext.mTranslationSnapCallback(&query, &result, gContext.mTranslationSnapUserData))
+            {
+               delta = makeVect(result.position[0], result.position[1], result.position[2]) - gContext.mModel.v.position;
+               delta.w = 0.f;
+               const vec_t normal = makeVect(result.surfaceNormal[0], result.surfaceNormal[1], result.surfaceNormal[2]);
+               if (normal.LengthSq() > FLT_EPSILON)
+               {
+                  if (result.alignToSurface)
+                  {
+                     surfaceNormal = Normalized(normal);
+                  }
+               }
+               else if (gContext.mCurrentOperation >= MT_MOVE_X && gContext.mCurrentOperation <= MT_MOVE_Z)
+               {
+                  const vec_t axisValue = Normalized(gContext.mModel.component[gContext.mCurrentOperation - MT_MOVE_X]);
+                  delta = axisValue * Dot(axisValue, delta);
+               }
+               else if (gContext.mCurrentOperation >= MT_MOVE_YZ && gContext.mCurrentOperation <= MT_MOVE_XY)
+               {
+                  const vec_t planeNormal = Normalized(gContext.mModel.component[gContext.mCurrentOperation - MT_MOVE_YZ]);
+                  delta -= planeNormal * Dot(planeNormal, delta);
+               }
+            }
+         }
+
          if (delta != gContext.mTranslationLastDelta)
          {
             modified = true;
@@ -2200,6 +3444,25 @@ namespace IMGUIZMO_NAMESPACE
          // compute matrix & delta
          matrix_t deltaMatrixTranslation;
          deltaMatrixTranslation.Translation(delta);
+
+         // surface alignment: the shortest rotation bringing the up axis onto the normal, around the object origin
+         if (surfaceNormal.LengthSq() > FLT_EPSILON)
+         {
+            const vec_t up = Normalized(gContext.mModelSource.v.up);
+            vec_t rotationAxis = Cross(up, surfaceNormal);
+            const float sinAngle = rotationAxis.Length();
+            const float cosAngle = Dot(up, surfaceNormal);
+            if (sinAngle > 1e-5f || cosAngle < 0.f)
+            {
+               rotationAxis = sinAngle > 1e-5f ? rotationAxis * (1.f / sinAngle) : Normalized(gContext.mModelSource.v.right);
+               matrix_t rotation, toOrigin, fromOrigin;
+               rotation.RotationAxis(rotationAxis, atan2f(sinAngle, cosAngle));
+               toOrigin.Translation(-gContext.mModelSource.v.position);
+               fromOrigin.Translation(gContext.mModelSource.v.position + delta);
+               deltaMatrixTranslation = toOrigin * rotation * fromOrigin;
+               modified = true;
+            }
+         }
          if (deltaMatrix)
          {
             memcpy(deltaMatrix, deltaMatrixTranslation.m16, sizeof(float) * 16);
@@ -2608,21 +3871,25 @@ namespace IMGUIZMO_NAMESPACE
    void AllowAxisFlip(bool value)
    {
      gContext.mAllowAxisFlip = value;
+     InvalidateTripodCache();
    }
 
    void SetAxisLimit(float value)
    {
      gContext.mAxisLimit=value;
+     InvalidateTripodCache();
    }
 
    void SetAxisMask(bool x, bool y, bool z)
    {
       gContext.mAxisMask = (x ? 1 : 0) + (y ? 2 : 0) + (z ? 4 : 0);
+      InvalidateTripodCache();
    }
 
    void SetPlaneLimit(float value)
    {
      gContext.mPlaneLimit = value;
+     InvalidateTripodCache();
    }
 
    bool IsOver(float* position, float pixelRadius)
@@ -2633,8 +3900,56 @@ namespace IMGUIZMO_NAMESPACE
       return radius < pixelRadius;
    }
 
+   int IsOverPositions(const float* positions, int count, int positionStride, const float* pixelRadii, int radiusStride, float pixelRadius, float* distance)
+   {
+      const ImVec2 mousePos = ImGui::GetIO().MousePos;
+
+      // positions are projected in batches through the vectorized path
+      static const int batchSize = 64;
+      float worldX[batchSize];
+      float worldY[batchSize];
+      float worldZ[batchSize];
+      ImVec2 screenPos[batchSize];
+      float clipW[batchSize];
+      int nearest = -1;
+      float nearestDistanceSqr = FLT_MAX;
+      for (int first = 0; first < count; first += batchSize)
+      {
+         const int batchCount = ImMin(batchSize, count - first);
+         for (int i = 0; i < batchCount; i++)
+         {
+            const float* position = positions + (size_t)(first + i) * positionStride;
+            worldX[i] = position[0];
+            worldY[i] = position[1];
+            worldZ[i] = position[2];
+         }
+         worldToPos(worldX, worldY, worldZ, batchCount, gContext.mViewProjection, screenPos, clipW);
+         for (int i = 0; i < batchCount; i++)
+         {
+            // behind the camera, the projection mirrors the position through the screen center
+            if (clipW[i] <= 0.f)
+            {
+               continue;
+            }
+            const float radius = pixelRadii ? pixelRadii[(size_t)(first + i) * radiusStride] : pixelRadius;
+            const float distanceSqr = ImLengthSqr(screenPos[i] - mousePos);
+            if (radius > 0.f && distanceSqr < radius * radius && distanceSqr < nearestDistanceSqr)
+            {
+               nearest = first + i;
+               nearestDistanceSqr = distanceSqr;
+            }
+         }
+      }
+      if (distance && nearest >= 0)
+      {
+         *distance = sqrtf(nearestDistanceSqr);
+      }
+      return nearest;
+   }
+
    bool Manipulate(const float* view, const float* projection, OPERATION operation, MODE mode, float* matrix, float* deltaMatrix, const float* snap, const float* localBounds, const float* boundsSnap)
    {
+      EnsureDrawList();
       gContext.mDrawList->PushClipRect (ImVec2 (gContext.mX, gContext.mY), ImVec2 (gContext.mX + gContext.mWidth, gContext.mY + gContext.mHeight), false);
 
       // Scale is always local or matrix will be skewed when applying world scale or oriented matrix
@@ -2685,6 +4000,83 @@ namespace IMGUIZMO_NAMESPACE
       return manipulated;
    }
 
+   bool ManipulateMany(const float* view, const float* projection, OPERATION operation, MODE mode, float* matrices, int matrixCount, PIVOT pivot, int activeIndex, bool* changed, const float* snap)
+   {
+      if (changed)
+      {
+         memset(changed, 0, sizeof(bool) * ImMax(matrixCount, 0));
+      }
+      if (matrixCount <= 0)
+      {
+         return false;
+      }
+      matrix_t* models = (matrix_t*)matrices;
+      activeIndex = ImClamp(activeIndex, 0, matrixCount - 1);
+
+      // while in use the gizmo keeps its own matrix from frame to frame, so scale and snapping
+      // accumulate exactly as they do for a single matrix. Calls with other IDs build theirs every time
+      matrix_t gizmo;
+      if (IsUsing() && gContext.mManyGizmoID == gContext.GetCurrentID())
+      {
+         gizmo = gContext.mManyGizmo;
+      }
+      else
+      {
+         vec_t position = models[activeIndex].v.position;
+         if (pivot == CENTROID)
+         {
+            position.Set(0.f);
+            for (int i = 0; i < matrixCount; i++)
+            {
+               position += models[i].v.position;
+            }
+            position *= 1.f / (float)matrixCount;
+         }
+         else if (pivot == BOUNDS_CENTER)
+         {
+            vec_t boundsMin = models[0].v.position;
+            vec_t boundsMax = boundsMin;
+            for (int i = 1; i < matrixCount; i++)
+            {
+               const vec_t& p = models[i].v.position;
+               boundsMin.Set(ImMin(boundsMin.x, p.x), ImMin(boundsMin.y, p.y), ImMin(boundsMin.z, p.z), 0.f);
+               boundsMax.Set(ImMax(boundsMax.x, p.x), ImMax(boundsMax.y, p.y), ImMax(boundsMax.z, p.z), 0.f);
+            }
+            position = (boundsMin + boundsMax) * 0.5f;
+         }
+         gizmo = models[activeIndex];
+         gizmo.OrthoNormalize();
+         gizmo.v.position.Set(position.x, position.y, position.z, 1.f);
+      }
+
+      const matrix_t gizmoBefore = gizmo;
+      const bool manipulated = Manipulate(view, projection, operation, mode, gizmo.m16, NULL, snap);
+      if (IsUsing())
+      {
+         gContext.mManyGizmo = gizmo;
+         gContext.mManyGizmoID = gContext.GetCurrentID();
+      }
+      if (!manipulated)
+      {
+         return false;
+      }
+
+      // world space change made by the gizmo this call
+      matrix_t gizmoBeforeInverse;
+      gizmoBeforeInverse.InverseClassified(gizmoBefore);
+      const matrix_t delta = gizmoBeforeInverse * gizmo;
+      for (int i = 0; i < matrixCount; i++)
+      {
+         const matrix_t res = models[i] * delta;
+         if (changed)
+         {
+            changed[i] = memcmp(&res, &models[i], sizeof(matrix_t)) != 0;
+         }
+         models[i] = res;
+      }
+      return true;
+   }
+
    void SetGizmoSizeClipSpace(float value)
    {
       gContext.mGizmoSizeClipSpace = value;
@@ -2729,34 +4121,74 @@ namespace IMGUIZMO_NAMESPACE
       }
    }
 
-   void DrawCubes(const float* view, const float* projection, const float* matrices, int matrixCount)
+   void SetTranslationSnapCallback(TranslationSnapCallback callback, void* userData)
    {
-      matrix_t viewInverse;
-      viewInverse.Inverse(*(matrix_t*)view);
+      gContext.mTranslationSnapCallback = callback;
+      gContext.mTranslationSnapUserData = userData;
+   }
+
+   void ComputeRectFrustum(ImVec2 screenMin, ImVec2 screenMax, float* planes)
+   {
+      IM_ASSERT(gContext.mCamera.mValid); // SetCamera was never called
+      const float x0 = ImMin(screenMin.x, screenMax.x), x1 = ImMax(screenMin.x, screenMax.x);
+      const float y0 = ImMin(screenMin.y, screenMax.y), y1 = ImMax(screenMin.y, screenMax.y);
+      // rectangle in normalized device coordinates, at least a pixel wide so a click still gives a volume
+      const float pixelX = 2.f / gContext.mWidth, pixelY = 2.f / gContext.mHeight;
+      const float left = (x0 - gContext.mX) * pixelX - 1.f;
+      const float right = ImMax((x1 - gContext.mX) * pixelX - 1.f, left + pixelX);
+      const float top = 1.f - (y0 - gContext.mY) * pixelY;
+      const float bottom = ImMin(1.f - (y1 - gContext.mY) * pixelY, top - pixelY);
+
+      // pick matrix: clip space scaled and offset so the rectangle covers [-1, 1], then the usual plane extraction
+      const float centerX = (left + right) * 0.5f, scaleX = 2.f / (right - left);
+      const float centerY = (bottom + top) * 0.5f, scaleY = 2.f / (top - bottom);
+      matrix_t clip = gContext.mCamera.mViewProjection;
+      for (int i = 0; i < 4; i++)
+      {
+         clip.m[i][0] = (clip.m[i][0] - centerX * clip.m[i][3]) * scaleX;
+         clip.m[i][1] = (clip.m[i][1] - centerY * clip.m[i][3]) * scaleY;
+      }
+      vec_t frustum[6];
+      ComputeFrustumPlanes(frustum, clip.m16);
+      for (int i = 0; i < 6; i++)
+      {
+         planes[i * 4 + 0] = frustum[i].x;
+         planes[i * 4 + 1] = frustum[i].y;
+         planes[i * 4 + 2] = frustum[i].z;
+         planes[i * 4 + 3] = frustum[i].w;
+      }
+   }
 
+   void DrawCubes(const float* view, const float* projection, const float* matrices, int matrixCount, int matrixStride)
+   {
+      EnsureDrawList();
       struct CubeFace
       {
          float z;
          ImVec2 faceCoordsScreen[4];
          ImU32 color;
       };
-      CubeFace* faces = (CubeFace*)_malloca(sizeof(CubeFace) * matrixCount * 6);
+      CubeFace* faces = (CubeFace*)gContext.mScratch.Alloc(sizeof(CubeFace) * matrixCount * 6);
 
       if (!faces)
       {
          return;
       }
 
+      const matrix_t& viewProjection = GetCamera(view, projection).mViewProjection;
       vec_t frustum[6];
-      matrix_t viewProjection = *(matrix_t*)view * *(matrix_t*)projection;
       ComputeFrustumPlanes(frustum, viewProjection.m16);
 
       int cubeFaceCount = 0;
       for (int cube = 0; cube < matrixCount; cube++)
       {
-         const float* matrix = &matrices[cube * 16];
+         const float* matrix = &matrices[(size_t)cube * matrixStride];
 
-         matrix_t res = *(matrix_t*)matrix * *(matrix_t*)view * *(matrix_t*)projection;
+         matrix_t res = *(matrix_t*)matrix * viewProjection;
+
+         // faces share the 8 cube corners (index bits are the x, y, z signs), projected once the first face is visible
+         ImVec2 cornersScreen[8];
+         bool cornersProjected = false;
 
          for (int iFace = 0; iFace < 6; iFace++)
          {
@@ -2811,10 +4243,20 @@ namespace IMGUIZMO_NAMESPACE
             CubeFace& cubeFace = faces[cubeFaceCount];
 
             // 3D->2D
-            //ImVec2 faceCoordsScreen[4];
+            if (!cornersProjected)
+            {
+               vec_t corners[8];
+               for (int iCorner = 0; iCorner < 8; iCorner++)
+               {
+                  corners[iCorner] = makeVect((iCorner & 1) ? 0.5f : -0.5f, (iCorner & 2) ? 0.5f : -0.5f, (iCorner & 4) ? 0.5f : -0.5f);
+               }
+               worldToPos(corners, 8, res, cornersScreen);
+               cornersProjected = true;
+            }
             for (unsigned int iCoord = 0; iCoord < 4; iCoord++)
             {
-               cubeFace.faceCoordsScreen[iCoord] = worldToPos(faceCoords[iCoord] * 0.5f * invert, res);
+               const vec_t corner = faceCoords[iCoord] * invert;
+               cubeFace.faceCoordsScreen[iCoord] = cornersScreen[(corner.x > 0.f ? 1 : 0) | (corner.y > 0.f ? 2 : 0) | (corner.z > 0.f ? 4 : 0)];
             }
 
             ImU32 directionColor = GetColorU32(DIRECTION_X + normalIndex);
@@ -2839,17 +4281,36 @@ namespace IMGUIZMO_NAMESPACE
          const CubeFace& cubeFace = faces[iFace];
          gContext.mDrawList->AddConvexPolyFilled(cubeFace.faceCoordsScreen, 4, cubeFace.color);
       }
-
-      _freea(faces);
    }
 
    void DrawGrid(const float* view, const float* projection, const float* matrix, const float gridSize)
    {
-      matrix_t viewProjection = *(matrix_t*)view * *(matrix_t*)projection;
-      matrix_t res = *(matrix_t*)matrix * viewProjection;
+      EnsureDrawList();
+      matrix_t res = *(matrix_t*)matrix * GetCamera(view, projection).mViewProjection;
       vec_t frustum[6];
       ComputeFrustumPlanes(frustum, res.m16);
 
+      // visible lines are buffered and projected in batches
+      static const int lineBatchSize = 64;
+      vec_t linePos[lineBatchSize * 2];
+      ImU32 lineColor[lineBatchSize];
+      float lineThickness[lineBatchSize];
+      int lineCount = 0;
+      auto flushLines = [&]()
+      {
+         if (lineCount == 0)
+         {
+            return;
+         }
+         ImVec2 lineSSpace[lineBatchSize * 2];
+         worldToPos(linePos, lineCount * 2, res, lineSSpace);
+         for (int i = 0; i < lineCount; i++)
+         {
+            gContext.mDrawList->AddLine(lineSSpace[i * 2], lineSSpace[i * 2 + 1], lineColor[i], lineThickness[i]);
+         }
+         lineCount = 0;
+      };
+
       for (float f = -gridSize; f <= gridSize; f += 1.f)
       {
          for (int dir = 0; dir < 2; dir++)
@@ -2893,10 +4354,18 @@ namespace IMGUIZMO_NAMESPACE
                thickness = (fmodf(fabsf(f), 10.f) < FLT_EPSILON) ? 1.5f : thickness;
                thickness = (fabsf(f) < FLT_EPSILON) ? 2.3f : thickness;
 
-               gContext.mDrawList->AddLine(worldToPos(ptA, res), worldToPos(ptB, res), col, thickness);
+               linePos[lineCount * 2] = ptA;
+               linePos[lineCount * 2 + 1] = ptB;
+               lineColor[lineCount] = col;
+               lineThickness[lineCount] = thickness;
+               if (++lineCount == lineBatchSize)
+               {
+                  flushLines();
+               }
             }
          }
       }
+      flushLines();
    }
 
    void SetGridColors(ImU32 minor, ImU32 major, ImU32 axis)
@@ -2908,6 +4377,7 @@ namespace IMGUIZMO_NAMESPACE
 
    void ViewManipulate(float* view, const float* projection, OPERATION operation, MODE mode, float* matrix, float length, ImVec2 position, ImVec2 size, ImU32 backgroundColor)
    {
+      EnsureDrawList();
       // Scale is always local or matrix will be skewed when applying world scale or oriented matrix
       ComputeContext(view, projection, matrix, (operation & SCALE) ? LOCAL : mode);
       ViewManipulate(view, length, position, size, backgroundColor);
@@ -2915,6 +4385,7 @@ namespace IMGUIZMO_NAMESPACE
 
    void ViewManipulate(float* view, float length, ImVec2 position, ImVec2 size, ImU32 backgroundColor)
    {
+      EnsureDrawList();
       static bool isDraging = false;
       static bool isClicking = false;
       static bool isInside = false;
@@ -2923,14 +4394,10 @@ namespace IMGUIZMO_NAMESPACE
       static int interpolationFrames = 0;
       const vec_t referenceUp = makeVect(0.f, 1.f, 0.f);
 
-      matrix_t svgView, svgProjection;
-      svgView = gContext.mViewMat;
-      svgProjection = gContext.mProjectionMat;
-
       ImGuiIO& io = ImGui::GetIO();
       gContext.mDrawList->AddRectFilled(position, position + size, backgroundColor);
       matrix_t viewInverse;
-      viewInverse.Inverse(*(matrix_t*)view);
+      viewInverse.InverseClassified(*(matrix_t*)view);
 
       const vec_t camTarget = viewInverse.v.position - viewInverse.v.dir * length;
 
@@ -2946,12 +4413,11 @@ namespace IMGUIZMO_NAMESPACE
       vec_t zero = makeVect(0.f, 0.f);
       LookAt(&eye.x, &zero.x, &up.x, cubeView.m16);
 
-      // set context
-      gContext.mViewMat = cubeView;
-      gContext.mProjectionMat = cubeProjection;
-      ComputeCameraRay(gContext.mRayOrigin, gContext.mRayVector, position, size);
-
-      const matrix_t res = cubeView * cubeProjection;
+      // cube camera ray, the cube projection is never reversed
+      gContext.mViewCubeProjectionCache.Update(cubeView, cubeProjection);
+      const matrix_t& res = gContext.mViewCubeProjectionCache.mViewProjection;
+      vec_t rayOrigin, rayVector;
+      ComputeCameraRay(rayOrigin, rayVector, gContext.mViewCubeProjectionCache.mViewProjectionInverse, false, position, size);
 
       // panels
       static const ImVec2 panelPosition[9] = { ImVec2(0.75f,0.75f), ImVec2(0.25f, 0.75f), ImVec2(0.f, 0.75f),
@@ -2994,8 +4460,8 @@ namespace IMGUIZMO_NAMESPACE
 
             const vec_t facePlan = BuildPlan(n * 0.5f, n);
 
-            const float len = IntersectRayPlane(gContext.mRayOrigin, gContext.mRayVector, facePlan);
-            vec_t posOnPlan = gContext.mRayOrigin + gContext.mRayVector * len - (n * 0.5f);
+            const float len = IntersectRayPlane(rayOrigin, rayVector, facePlan);
+            vec_t posOnPlan = rayOrigin + rayVector * len - (n * 0.5f);
 
             float localx = Dot(directionUnary[perpXIndex], posOnPlan) * invert + 0.5f;
             float localy = Dot(directionUnary[perpYIndex], posOnPlan) * invert + 0.5f;
@@ -3004,21 +4470,23 @@ namespace IMGUIZMO_NAMESPACE
             const vec_t dx = directionUnary[perpXIndex];
             const vec_t dy = directionUnary[perpYIndex];
             const vec_t origin = directionUnary[normalIndex] - dx - dy;
-            for (int iPanel = 0; iPanel < 9; iPanel++)
+
+            // panel corners lie on a 4x4 lattice of the face, only needed for drawing
+            static const float latticeCoords[4] = { 0.f, 0.5f, 1.5f, 2.f };
+            ImVec2 latticeScreen[16];
+            if (iPass)
             {
-               vec_t boxCoord = boxOrigin + indexVectorX * float(iPanel % 3) + indexVectorY * float(iPanel / 3) + makeVect(1.f, 1.f, 1.f);
-               const ImVec2 p = panelPosition[iPanel] * 2.f;
-               const ImVec2 s = panelSize[iPanel] * 2.f;
-               ImVec2 faceCoordsScreen[4];
-               vec_t panelPos[4] = { dx * p.x + dy * p.y,
-                                     dx * p.x + dy * (p.y + s.y),
-                                     dx * (p.x + s.x) + dy * (p.y + s.y),
-                                     dx * (p.x + s.x) + dy * p.y };
-
-               for (unsigned int iCoord = 0; iCoord < 4; iCoord++)
+               vec_t latticePos[16];
+               for (int iLattice = 0; iLattice < 16; iLattice++)
                {
-                  faceCoordsScreen[iCoord] = worldToPos((panelPos[iCoord] + origin) * 0.5f * invert, res, position, size);
+                  latticePos[iLattice] = (dx * latticeCoords[iLattice & 3] + dy * latticeCoords[iLattice >> 2] + origin) * 0.5f * invert;
                }
+               worldToPos(latticePos, 16, res, latticeScreen, position, size);
+            }
+
+            for (int iPanel = 0; iPanel < 9; iPanel++)
+            {
+               vec_t boxCoord = boxOrigin + indexVectorX * float(iPanel % 3) + indexVectorY * float(iPanel / 3) + makeVect(1.f, 1.f, 1.f);
 
                const ImVec2 panelCorners[2] = { panelPosition[iPanel], panelPosition[iPanel] + panelSize[iPanel] };
                bool insidePanel = localx > panelCorners[0].x && localx < panelCorners[1].x && localy > panelCorners[0].y && localy < panelCorners[1].y;
@@ -3029,6 +4497,9 @@ namespace IMGUIZMO_NAMESPACE
                // draw face with lighter color
                if (iPass)
                {
+                  // lattice index of the panel's lowest corner
+                  const int latticeBase = (2 - iPanel / 3) * 4 + (2 - iPanel % 3);
+                  const ImVec2 faceCoordsScreen[4] = { latticeScreen[latticeBase], latticeScreen[latticeBase + 4], latticeScreen[latticeBase + 5], latticeScreen[latticeBase + 1] };
                   ImU32 directionColor = GetColorU32(DIRECTION_X + normalIndex);
                   gContext.mDrawList->AddConvexPolyFilled(faceCoordsScreen, 4, (directionColor | IM_COL32(0x80, 0x80, 0x80, 0x80)) | (isInside ? IM_COL32(0x08, 0x08, 0x08, 0) : 0));
                   if (boxes[boxCoordInt])
@@ -3133,8 +4604,5 @@ namespace IMGUIZMO_NAMESPACE
       }
 
       gContext.mbUsingViewManipulate = (interpolationFrames != 0) || isDraging;
-
-      // restore view/projection because it was used to compute ray
-      ComputeContext(svgView.m16, svgProjection.m16, gContext.mModelSource.m16, gContext.mMode);
    }
 };
@@ -0,0 +1,892 @@
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <vector>
+
+// same switch as imguizmo.cpp: IMGUIZMO_DISABLE_SIMD forces the scalar path
+#if !defined(IMGUIZMO_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PICKING_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PICKING_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#include "picking.h"
+#include "bvh_util.h"
+
+namespace Picking
+{
+
+using namespace Bvh;
+
+enum Shape
+{
+    SHAPE_AABB,
+    SHAPE_SPHERE
+};
+
+struct Object
+{
+    float inverse[16];  // world to local, to test the ray against the local shape
+    float shape[6];     // AABB min and max, or sphere center and radius
+    float bounds_min[3]; // world bounds
+    float bounds_max[3];
+    int type;
+    int handle;         // 0 for a slot freed by Remove
+    int leaf;           // node holding the object
+    bool invertible;
+};
+
+static const int MAX_LEAF_SIZE = 4;
+static const int BIN_COUNT = 12;
+static const int MAX_DEPTH = 60; // deeper nodes become leaves, so traversal stacks have a fixed size
+static const float REBUILD_COST_RATIO = 1.5f;
+static const float TRAVERSAL_COST = 1.0f; // relative to testing one object
+static const int MAX_SELECT_PLANES = 8;   // two SIMD groups of four planes
+static const int FREE_NODE = -2;          // parent of the nodes Remove took out of the hierarchy
+
+// object bounds in build order, so the build reads memory linearly
+struct BuildItem
+{
+    float min[3];
+    float max[3];
+    float centroid[3];
+    int index;
+};
+
+struct Scene
+{
+    std::vector<Object> objects;    // a contiguous run per leaf, sorted by leaf on build, freed slots wait for the next one
+    HandleTable handles;
+    std::vector<Node> nodes;        // children are always stored after their parent
+    std::vector<int> parents;       // -1 for the root, FREE_NODE for nodes out of the hierarchy
+    std::vector<char> scattered;    // internal nodes whose objects no longer form one run since an insert or remove
+    std::vector<int> dirty;         // handles of objects moved since the last refit
+    std::vector<BuildItem> items;   // build scratch, kept for the next build
+    std::vector<int> selection;     // handles returned by SelectInPlanes, reused between calls
+    int object_count = 0;
+    bool rebuild = true;
+    float built_cost = 0.0f;        // SAH cost right after the last build
+    double cost_sum = 0.0;          // NodeCost summed over the hierarchy, updated with every node change
+    int removed_since_build = 0;    // bounds the freed slots and nodes
+};
+
+static Scene g_Scene;
+
+// world bounds of the shape: a transformed box keeps its center, extents are summed over the absolute matrix
+static void UpdateObject(Object& object, const float* m)
+{
+    object.invertible = InverseAffine(m, object.inverse);
+    if (!object.invertible) {
+        // a flattened object can't be hit, it stays out of the bounds
+        ClearBounds(object.bounds_min, object.bounds_max);
+        return;
+    }
+
+    float center[3];
+    float extent[3];
+    if (object.type == SHAPE_AABB) {
+        float local_center[3];
+        float local_extent[3];
+        for (int i = 0; i < 3; ++i) {
+            local_center[i] = (object.shape[i] + object.shape[3 + i]) * 0.5f;
+            local_extent[i] = (object.shape[3 + i] - object.shape[i]) * 0.5f;
+        }
+        TransformPoint(m, local_center, center);
+        for (int i = 0; i < 3; ++i) {
+            extent[i] = fabsf(m[i]) * local_extent[0] + fabsf(m[4 + i]) * local_extent[1] + fabsf(m[8 + i]) * local_extent[2];
+        }
+    } else {
+        TransformPoint(m, object.shape, center);
+        const float radius = object.shape[3];
+        for (int i = 0; i < 3; ++i) {
+            extent[i] = radius * sqrtf(m[i] * m[i] + m[4 + i] * m[4 + i] + m[8 + i] * m[8 + i]);
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        object.bounds_min[i] = center[i] - extent[i];
+        object.bounds_max[i] = center[i] + extent[i];
+    }
+}
+
+static Object* GetObject(int handle)
+{
+    Scene& scene = g_Scene;
+    int index = scene.handles.Find(handle);
+    return index < 0 ? NULL : &scene.objects[index];
+}
+
+// SAH weight of a node: its area times the objects a leaf tests, one box test for an internal node
+static float NodeCost(const Node& node)
+{
+    return Area(node.min, node.max) * (node.count ? (float)node.count : 1.0f);
+}
+
+static void ComputeLeafBounds(Node& node)
+{
+    Scene& scene = g_Scene;
+    ClearBounds(node.min, node.max);
+    for (int i = 0; i < node.count; ++i) {
+        const Object& object = scene.objects[node.first + i];
+        GrowBounds(node.min, node.max, object.bounds_min, object.bounds_max);
+    }
+}
+
+static void RefitNode(int index)
+{
+    Scene& scene = g_Scene;
+    Node& node = scene.nodes[index];
+    scene.cost_sum -= NodeCost(node);
+    if (node.count) {
+        ComputeLeafBounds(node);
+    } else {
+        const Node& left = scene.nodes[node.first];
+        const Node& right = scene.nodes[node.first + 1];
+        for (int i = 0; i < 3; ++i) {
+            node.min[i] = Min(left.min[i], right.min[i]);
+            node.max[i] = Max(left.max[i], right.max[i]);
+        }
+    }
+    scene.cost_sum += NodeCost(node);
+}
+
+// refits a node and its ancestors until their bounds stop changing
+static void RefitUp(int index)
+{
+    Scene& scene = g_Scene;
+    while (index >= 0) {
+        Node& node = scene.nodes[index];
+        float previous[6] = { node.min[0], node.min[1], node.min[2], node.max[0], node.max[1], node.max[2] };
+        RefitNode(index);
+        float current[6] = { node.min[0], node.min[1], node.min[2], node.max[0], node.max[1], node.max[2] };
+        if (memcmp(previous, current, sizeof(current)) == 0) {
+            break;
+        }
+        index = scene.parents[index];
+    }
+}
+
+// an insert or remove below a node moves objects out of the run its subtree got from the build
+static void Scatter(int index)
+{
+    Scene& scene = g_Scene;
+    while (index >= 0 && !scene.scattered[index]) {
+        scene.scattered[index] = 1;
+        index = scene.parents[index];
+    }
+}
+
+// descends to the leaf whose bounds grow least and stores the object in it: in the free slot after its run when
+// the leaf has room, otherwise in a new leaf beside it. Returns the slot of the object
+static int Insert(const Object& object)
+{
+    Scene& scene = g_Scene;
+    int leaf = 0;
+    int depth = 0;
+    while (scene.nodes[leaf].count == 0) {
+        const Node& node = scene.nodes[leaf];
+        float growth[2];
+        float area[2];
+        for (int i = 0; i < 2; ++i) {
+            const Node& child = scene.nodes[node.first + i];
+            float min[3] = { child.min[0], child.min[1], child.min[2] };
+            float max[3] = { child.max[0], child.max[1], child.max[2] };
+            GrowBounds(min, max, object.bounds_min, object.bounds_max);
+            area[i] = Area(min, max);
+            growth[i] = area[i] - Area(child.min, child.max);
+        }
+        bool right = growth[1] < growth[0] || (growth[1] == growth[0] && area[1] < area[0]);
+        leaf = node.first + (right ? 1 : 0);
+        depth++;
+    }
+
+    Node& node = scene.nodes[leaf];
+    int slot = node.first + node.count;
+    if (node.count < MAX_LEAF_SIZE && (slot == (int)scene.objects.size() || scene.objects[slot].handle == 0)) {
+        if (slot == (int)scene.objects.size()) {
+            scene.objects.push_back(object);
+        } else {
+            scene.objects[slot] = object;
+        }
+        scene.objects[slot].leaf = leaf;
+        scene.cost_sum -= NodeCost(node);
+        node.count++;
+        scene.cost_sum += NodeCost(node);
+        Scatter(scene.parents[leaf]);
+        RefitUp(leaf);
+        return slot;
+    }
+
+    slot = (int)scene.objects.size();
+    scene.objects.push_back(object);
+    if (depth >= MAX_DEPTH) {
+        // a new level would outgrow the traversal stacks
+        scene.rebuild = true;
+        return slot;
+    }
+
+    // the leaf becomes the parent of its old run and of the new object
+    Node left = node;
+    Node right;
+    right.first = slot;
+    right.count = 1;
+    memcpy(right.min, object.bounds_min, sizeof(right.min));
+    memcpy(right.max, object.bounds_max, sizeof(right.max));
+    int left_index = (int)scene.nodes.size();
+    scene.cost_sum -= NodeCost(node);
+    node.first = left_index;
+    node.count = 0;
+    scene.cost_sum += NodeCost(node) + NodeCost(left) + NodeCost(right);
+    scene.nodes.push_back(left);
+    scene.nodes.push_back(right);
+    scene.parents.push_back(leaf);
+    scene.parents.push_back(leaf);
+    scene.scattered.push_back(0);
+    scene.scattered.push_back(0);
+    Scatter(leaf);
+    for (int i = 0; i < left.count; ++i) {
+        scene.objects[left.first + i].leaf = left_index;
+    }
+    scene.objects[slot].leaf = left_index + 1;
+    RefitUp(leaf);
+    return slot;
+}
+
+// an emptied leaf leaves the hierarchy: its sibling takes the place of their parent
+static void RemoveLeaf(int leaf)
+{
+    Scene& scene = g_Scene;
+    int parent = scene.parents[leaf];
+    if (parent < 0) {
+        scene.nodes.clear();
+        scene.parents.clear();
+        scene.scattered.clear();
+        scene.cost_sum = 0.0;
+        return;
+    }
+    int first = scene.nodes[parent].first;
+    int sibling = leaf == first ? first + 1 : first;
+    scene.cost_sum -= NodeCost(scene.nodes[leaf]) + NodeCost(scene.nodes[sibling]) + NodeCost(scene.nodes[parent]);
+    scene.nodes[parent] = scene.nodes[sibling];
+    scene.scattered[parent] = scene.scattered[sibling];
+    scene.parents[first] = FREE_NODE;
+    scene.parents[first + 1] = FREE_NODE;
+
+    const Node& node = scene.nodes[parent];
+    scene.cost_sum += NodeCost(node);
+    if (node.count) {
+        for (int i = 0; i < node.count; ++i) {
+            scene.objects[node.first + i].leaf = parent;
+        }
+    } else {
+        // the children keep coming after their new parent, the sibling was stored after it
+        scene.parents[node.first] = parent;
+        scene.parents[node.first + 1] = parent;
+    }
+    RefitUp(scene.parents[parent]);
+}
+
+static int Add(int type, const float* matrix, const float* shape)
+{
+    Scene& scene = g_Scene;
+    int handle = scene.handles.Allocate(-1);
+    Object object;
+    memcpy(object.shape, shape, sizeof(object.shape));
+    object.type = type;
+    object.handle = handle;
+    object.leaf = -1;
+    UpdateObject(object, matrix);
+
+    int index;
+    if (scene.rebuild || scene.nodes.empty()) {
+        index = (int)scene.objects.size();
+        scene.objects.push_back(object);
+        scene.rebuild = true;
+    } else {
+        index = Insert(object);
+    }
+    scene.handles.index[handle] = index;
+    scene.object_count++;
+    return handle;
+}
+
+int AddAABB(const float* matrix, const float* min, const float* max)
+{
+    float shape[6] = { fminf(min[0], max[0]), fminf(min[1], max[1]), fminf(min[2], max[2]),
+        fmaxf(min[0], max[0]), fmaxf(min[1], max[1]), fmaxf(min[2], max[2]) };
+    return Add(SHAPE_AABB, matrix, shape);
+}
+
+int AddSphere(const float* matrix, const float* center, float radius)
+{
+    float shape[6] = { center[0], center[1], center[2], fabsf(radius), 0.0f, 0.0f };
+    return Add(SHAPE_SPHERE, matrix, shape);
+}
+
+bool SetMatrix(int handle, const float* matrix)
+{
+    Object* object = GetObject(handle);
+    if (object == NULL) {
+        return false;
+    }
+    UpdateObject(*object, matrix);
+    if (!g_Scene.rebuild) {
+        g_Scene.dirty.push_back(handle);
+    }
+    return true;
+}
+
+// the last object of the leaf run fills the slot of the removed one, the freed slot at the end of the run can take
+// the next object inserted in the leaf
+bool Remove(int handle)
+{
+    Scene& scene = g_Scene;
+    int index = scene.handles.Find(handle);
+    if (index < 0) {
+        return false;
+    }
+    scene.handles.Release(handle);
+    scene.object_count--;
+    int freed = index;
+    if (!scene.rebuild) {
+        int leaf = scene.objects[index].leaf;
+        Node& node = scene.nodes[leaf];
+        freed = node.first + node.count - 1;
+        if (freed != index) {
+            scene.objects[index] = scene.objects[freed];
+            scene.handles.index[scene.objects[index].handle] = index;
+        }
+        Scatter(scene.parents[leaf]);
+        if (node.count > 1) {
+            scene.cost_sum -= NodeCost(node);
+            node.count--;
+            scene.cost_sum += NodeCost(node);
+            RefitUp(leaf);
+        } else {
+            RemoveLeaf(leaf);
+        }
+        scene.removed_since_build++;
+    }
+    scene.objects[freed].handle = 0;
+    while (!scene.objects.empty() && scene.objects.back().handle == 0) {
+        scene.objects.pop_back();
+    }
+    return true;
+}
+
+void Clear()
+{
+    Scene& scene = g_Scene;
+    scene.objects.clear();
+    scene.handles.Clear();
+    scene.nodes.clear();
+    scene.parents.clear();
+    scene.scattered.clear();
+    scene.dirty.clear();
+    scene.selection.clear();
+    scene.object_count = 0;
+    scene.rebuild = true;
+}
+
+int GetCount()
+{
+    return g_Scene.object_count;
+}
+
+static void ComputeItemsBounds(int first, int count, float* min, float* max)
+{
+    const BuildItem* items = &g_Scene.items[first];
+    ClearBounds(min, max);
+    for (int i = 0; i < count; ++i) {
+        GrowBounds(min, max, items[i].min, items[i].max);
+    }
+}
+
+// binned SAH split over the three axes, false when keeping a leaf is cheaper
+static bool FindSplit(const Node& node, int* out_axis, float* out_position)
+{
+    const BuildItem* items = &g_Scene.items[node.first];
+    float centroid_min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float centroid_max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int i = 0; i < node.count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            centroid_min[axis] = Min(centroid_min[axis], items[i].centroid[axis]);
+            centroid_max[axis] = Max(centroid_max[axis], items[i].centroid[axis]);
+        }
+    }
+
+    const float area = Area(node.min, node.max);
+    float best_cost = node.count * area - TRAVERSAL_COST * area;
+    bool found = false;
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = centroid_max[axis] - centroid_min[axis];
+        if (extent <= 0.0f) {
+            continue;
+        }
+        struct Bin
+        {
+            float min[3];
+            float max[3];
+            int count;
+        };
+        Bin bins[BIN_COUNT];
+        for (int b = 0; b < BIN_COUNT; ++b) {
+            ClearBounds(bins[b].min, bins[b].max);
+            bins[b].count = 0;
+        }
+        float scale = BIN_COUNT / extent;
+        for (int i = 0; i < node.count; ++i) {
+            int b = (int)((items[i].centroid[axis] - centroid_min[axis]) * scale);
+            b = b < BIN_COUNT - 1 ? b : BIN_COUNT - 1;
+            bins[b].count++;
+            GrowBounds(bins[b].min, bins[b].max, items[i].min, items[i].max);
+        }
+
+        // sweep from both sides to get the cost of every split plane
+        float left_area[BIN_COUNT - 1];
+        int left_count[BIN_COUNT - 1];
+        float bounds_min[3];
+        float bounds_max[3];
+        ClearBounds(bounds_min, bounds_max);
+        int count = 0;
+        for (int b = 0; b < BIN_COUNT - 1; ++b) {
+            count += bins[b].count;
+            GrowBounds(bounds_min, bounds_max, bins[b].min, bins[b].max);
+            left_count[b] = count;
+            left_area[b] = Area(bounds_min, bounds_max);
+        }
+        ClearBounds(bounds_min, bounds_max);
+        count = 0;
+        for (int b = BIN_COUNT - 1; b > 0; --b) {
+            count += bins[b].count;
+            GrowBounds(bounds_min, bounds_max, bins[b].min, bins[b].max);
+            if (left_count[b - 1] == 0 || count == 0) {
+                continue;
+            }
+            float cost = left_count[b - 1] * left_area[b - 1] + count * Area(bounds_min, bounds_max);
+            if (cost < best_cost) {
+                best_cost = cost;
+                *out_axis = axis;
+                *out_position = centroid_min[axis] + b / scale;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+// exact cost sum over the hierarchy, drops the rounding the incremental updates accumulated
+static void SumCost()
+{
+    Scene& scene = g_Scene;
+    scene.cost_sum = 0.0;
+    for (size_t i = 0; i < scene.nodes.size(); ++i) {
+        if (scene.parents[i] != FREE_NODE) {
+            scene.cost_sum += NodeCost(scene.nodes[i]);
+        }
+    }
+}
+
+// SAH cost of the hierarchy relative to its root, to detect refits and edits that degraded it
+static float ComputeCost()
+{
+    Scene& scene = g_Scene;
+    float root_area = scene.nodes.empty() ? 0.0f : Area(scene.nodes[0].min, scene.nodes[0].max);
+    if (root_area <= 0.0f) {
+        return 0.0f;
+    }
+    return (float)(scene.cost_sum / root_area);
+}
+
+static void Build()
+{
+    Scene& scene = g_Scene;
+    scene.rebuild = false;
+    scene.dirty.clear();
+    scene.removed_since_build = 0;
+    scene.nodes.clear();
+    scene.parents.clear();
+    scene.scattered.clear();
+    scene.cost_sum = 0.0;
+    scene.built_cost = 0.0f;
+    int count = scene.object_count;
+    if (count == 0) {
+        scene.objects.clear();
+        return;
+    }
+
+    scene.items.resize(count);
+    int live = 0;
+    for (int i = 0; i < (int)scene.objects.size(); ++i) {
+        const Object& object = scene.objects[i];
+        if (object.handle == 0) {
+            continue;
+        }
+        BuildItem& item = scene.items[live++];
+        memcpy(item.min, object.bounds_min, sizeof(item.min));
+        memcpy(item.max, object.bounds_max, sizeof(item.max));
+        for (int axis = 0; axis < 3; ++axis) {
+            // objects without bounds gather at the origin
+            item.centroid[axis] = object.invertible ? (item.min[axis] + item.max[axis]) * 0.5f : 0.0f;
+        }
+        item.index = i;
+    }
+
+    Node root;
+    root.first = 0;
+    root.count = count;
+    ComputeItemsBounds(0, count, root.min, root.max);
+    scene.nodes.reserve(2 * (count / 2 + 1));
+    scene.nodes.push_back(root);
+    scene.parents.push_back(-1);
+
+    struct Task
+    {
+        int node;
+        int depth;
+    };
+    std::vector<Task> tasks;
+    tasks.push_back({ 0, 0 });
+    while (!tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        Node node = scene.nodes[task.node];
+
+        int axis = 0;
+        float position = 0.0f;
+        bool split = node.count > 1 && task.depth < MAX_DEPTH && FindSplit(node, &axis, &position);
+        if (!split && node.count > MAX_LEAF_SIZE && task.depth < MAX_DEPTH) {
+            // cheaper as a leaf but too large: halve along the longest axis
+            float extent[3] = { node.max[0] - node.min[0], node.max[1] - node.min[1], node.max[2] - node.min[2] };
+            axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+            position = (node.min[axis] + node.max[axis]) * 0.5f;
+            split = true;
+        }
+
+        int middle = node.first;
+        if (split) {
+            BuildItem* items = &scene.items[0];
+            int last = node.first + node.count - 1;
+            while (middle <= last) {
+                if (items[middle].centroid[axis] < position) {
+                    middle++;
+                } else {
+                    BuildItem tmp = items[middle];
+                    items[middle] = items[last];
+                    items[last--] = tmp;
+                }
+            }
+            if (middle == node.first || middle == node.first + node.count) {
+                // all centroids on one side, split the range in two
+                middle = node.first + node.count / 2;
+                split = node.count > MAX_LEAF_SIZE;
+            }
+        }
+
+        if (!split) {
+            continue;
+        }
+
+        Node left;
+        left.first = node.first;
+        left.count = middle - node.first;
+        ComputeItemsBounds(left.first, left.count, left.min, left.max);
+        Node right;
+        right.first = middle;
+        right.count = node.count - left.count;
+        ComputeItemsBounds(right.first, right.count, right.min, right.max);
+
+        int left_index = (int)scene.nodes.size();
+        scene.nodes[task.node].first = left_index;
+        scene.nodes[task.node].count = 0;
+        scene.nodes.push_back(left);
+        scene.nodes.push_back(right);
+        scene.parents.push_back(task.node);
+        scene.parents.push_back(task.node);
+        tasks.push_back({ left_index, task.depth + 1 });
+        tasks.push_back({ left_index + 1, task.depth + 1 });
+    }
+
+    // objects move to build order so every leaf reads a contiguous run of them
+    std::vector<Object> sorted(count);
+    for (int i = 0; i < count; ++i) {
+        sorted[i] = scene.objects[scene.items[i].index];
+        scene.handles.index[sorted[i].handle] = i;
+    }
+    scene.objects.swap(sorted);
+    for (size_t i = 0; i < scene.nodes.size(); ++i) {
+        const Node& node = scene.nodes[i];
+        for (int j = 0; j < node.count; ++j) {
+            scene.objects[node.first + j].leaf = (int)i;
+        }
+    }
+    scene.scattered.assign(scene.nodes.size(), 0);
+    SumCost();
+    scene.built_cost = ComputeCost();
+}
+
+// bounds of moved objects pushed up to the root, the whole tree when many moved
+static void Refit()
+{
+    Scene& scene = g_Scene;
+    if (scene.dirty.size() * 4 > (size_t)scene.object_count) {
+        for (int i = (int)scene.nodes.size() - 1; i >= 0; --i) {
+            if (scene.parents[i] != FREE_NODE) {
+                RefitNode(i);
+            }
+        }
+        SumCost();
+    } else {
+        for (size_t i = 0; i < scene.dirty.size(); ++i) {
+            // handles removed since they moved are skipped
+            int index = scene.handles.Find(scene.dirty[i]);
+            if (index >= 0) {
+                RefitUp(scene.objects[index].leaf);
+            }
+        }
+    }
+    scene.dirty.clear();
+}
+
+// refits, inserts and removes all keep the cost up to date, a full build only runs once it degraded too far
+// or when removes left as many freed slots as there are objects
+static void Prepare()
+{
+    Scene& scene = g_Scene;
+    if (!scene.rebuild && !scene.dirty.empty()) {
+        Refit();
+    }
+    if (!scene.rebuild && (ComputeCost() > scene.built_cost * REBUILD_COST_RATIO ||
+        scene.removed_since_build > scene.object_count)) {
+        scene.rebuild = true;
+    }
+    if (scene.rebuild) {
+        Build();
+    }
+}
+
+// the ray in the object's local space keeps the world ray parameter, so distances compare across objects
+static float RayObject(const Object& object, const float* origin, const float* direction, float max_distance)
+{
+    if (!object.invertible) {
+        return FLT_MAX;
+    }
+    float local_origin[3];
+    float local_direction[3];
+    TransformPoint(object.inverse, origin, local_origin);
+    TransformVector(object.inverse, direction, local_direction);
+
+    if (object.type == SHAPE_AABB) {
+        float inv_direction[3];
+        for (int i = 0; i < 3; ++i) {
+            inv_direction[i] = 1.0f / local_direction[i];
+        }
+        return RayBox(local_origin, inv_direction, object.shape, object.shape + 3, max_distance);
+    }
+
+    float oc[3] = { local_origin[0] - object.shape[0], local_origin[1] - object.shape[1], local_origin[2] - object.shape[2] };
+    float a = local_direction[0] * local_direction[0] + local_direction[1] * local_direction[1] + local_direction[2] * local_direction[2];
+    float b = oc[0] * local_direction[0] + oc[1] * local_direction[1] + oc[2] * local_direction[2];
+    float c = oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] - object.shape[3] * object.shape[3];
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f || a <= 0.0f) {
+        return FLT_MAX;
+    }
+    float root = sqrtf(discriminant);
+    float t = (-b - root) / a;
+    if (t < 0.0f) {
+        // origin inside the sphere
+        t = (-b + root) / a >= 0.0f ? 0.0f : FLT_MAX;
+    }
+    return t <= max_distance ? t : FLT_MAX;
+}
+
+int Raycast(const float* ray_origin, const float* ray_direction, float max_distance, float* distance)
+{
+    Prepare();
+    Scene& scene = g_Scene;
+    if (scene.nodes.empty()) {
+        return 0;
+    }
+
+    float inv_direction[3];
+    for (int i = 0; i < 3; ++i) {
+        inv_direction[i] = 1.0f / ray_direction[i];
+    }
+
+    float best = max_distance;
+    int best_index = -1;
+    RaycastNodes<MAX_DEPTH + 2>(&scene.nodes[0], ray_origin, inv_direction, best, [&](const Node& node) {
+        for (int i = 0; i < node.count; ++i) {
+            int index = node.first + i;
+            float t = RayObject(scene.objects[index], ray_origin, ray_direction, best);
+            if (t < FLT_MAX) {
+                best = t;
+                best_index = index;
+            }
+        }
+    });
+
+    if (best_index < 0) {
+        return 0;
+    }
+    if (distance) {
+        *distance = best;
+    }
+    return scene.objects[best_index].handle;
+}
+
+// planes in structure of arrays, padded with an always passing plane to two groups of four
+struct Frustum
+{
+    float a[MAX_SELECT_PLANES];
+    float b[MAX_SELECT_PLANES];
+    float c[MAX_SELECT_PLANES];
+    float d[MAX_SELECT_PLANES];
+    float abs_a[MAX_SELECT_PLANES];
+    float abs_b[MAX_SELECT_PLANES];
+    float abs_c[MAX_SELECT_PLANES];
+};
+
+enum Containment
+{
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
+// box against all planes at once: the center distance d and the box radius r projected on the normal give
+// outside when d + r < 0 for any plane, inside when d - r >= 0 for every plane
+static Containment ClassifyBox(const Frustum& frustum, const float* min, const float* max)
+{
+    const float cx = (min[0] + max[0]) * 0.5f, ex = (max[0] - min[0]) * 0.5f;
+    const float cy = (min[1] + max[1]) * 0.5f, ey = (max[1] - min[1]) * 0.5f;
+    const float cz = (min[2] + max[2]) * 0.5f, ez = (max[2] - min[2]) * 0.5f;
+#if defined(PICKING_SIMD_SSE)
+    const __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy), vcz = _mm_set1_ps(cz);
+    const __m128 vex = _mm_set1_ps(ex), vey = _mm_set1_ps(ey), vez = _mm_set1_ps(ez);
+    const __m128 zero = _mm_setzero_ps();
+    int outside = 0;
+    int inside = 0;
+    for (int i = 0; i < MAX_SELECT_PLANES; i += 4) {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(frustum.a + i), vcx), _mm_mul_ps(_mm_loadu_ps(frustum.b + i), vcy)),
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(frustum.c + i), vcz), _mm_loadu_ps(frustum.d + i)));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(frustum.abs_a + i), vex), _mm_mul_ps(_mm_loadu_ps(frustum.abs_b + i), vey)),
+            _mm_mul_ps(_mm_loadu_ps(frustum.abs_c + i), vez));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), zero));
+        inside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(d, r), zero));
+    }
+    return outside ? OUTSIDE : (inside ? INTERSECTING : INSIDE);
+#elif defined(PICKING_SIMD_NEON)
+    const float32x4_t vcx = vdupq_n_f32(cx), vcy = vdupq_n_f32(cy), vcz = vdupq_n_f32(cz);
+    const float32x4_t vex = vdupq_n_f32(ex), vey = vdupq_n_f32(ey), vez = vdupq_n_f32(ez);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    uint32x4_t outside = vdupq_n_u32(0);
+    uint32x4_t inside = vdupq_n_u32(0);
+    for (int i = 0; i < MAX_SELECT_PLANES; i += 4) {
+        float32x4_t d = vaddq_f32(vaddq_f32(vmulq_f32(vld1q_f32(frustum.a + i), vcx), vmulq_f32(vld1q_f32(frustum.b + i), vcy)),
+            vaddq_f32(vmulq_f32(vld1q_f32(frustum.c + i), vcz), vld1q_f32(frustum.d + i)));
+        float32x4_t r = vaddq_f32(vaddq_f32(vmulq_f32(vld1q_f32(frustum.abs_a + i), vex), vmulq_f32(vld1q_f32(frustum.abs_b + i), vey)),
+            vmulq_f32(vld1q_f32(frustum.abs_c + i), vez));
+        outside = vorrq_u32(outside, vcltq_f32(vaddq_f32(d, r), zero));
+        inside = vorrq_u32(inside, vcltq_f32(vsubq_f32(d, r), zero));
+    }
+    uint32x2_t outside_half = vorr_u32(vget_low_u32(outside), vget_high_u32(outside));
+    uint32x2_t inside_half = vorr_u32(vget_low_u32(inside), vget_high_u32(inside));
+    if (vget_lane_u32(outside_half, 0) | vget_lane_u32(outside_half, 1)) {
+        return OUTSIDE;
+    }
+    return (vget_lane_u32(inside_half, 0) | vget_lane_u32(inside_half, 1)) ? INTERSECTING : INSIDE;
+#else
+    Containment result = INSIDE;
+    for (int i = 0; i < MAX_SELECT_PLANES; ++i) {
+        float d = frustum.a[i] * cx + frustum.b[i] * cy + frustum.c[i] * cz + frustum.d[i];
+        float r = frustum.abs_a[i] * ex + frustum.abs_b[i] * ey + frustum.abs_c[i] * ez;
+        if (d + r < 0.0f) {
+            return OUTSIDE;
+        }
+        if (d - r < 0.0f) {
+            result = INTERSECTING;
+        }
+    }
+    return result;
+#endif
+}
+
+int SelectInPlanes(const float* planes, int plane_count, const int** out_handles)
+{
+    Prepare();
+    Scene& scene = g_Scene;
+    scene.selection.clear();
+    *out_handles = NULL;
+    if (scene.nodes.empty() || scene.nodes[0].min[0] > scene.nodes[0].max[0]) {
+        return 0;
+    }
+
+    Frustum frustum;
+    plane_count = plane_count < MAX_SELECT_PLANES ? plane_count : MAX_SELECT_PLANES;
+    for (int i = 0; i < MAX_SELECT_PLANES; ++i) {
+        const float padding[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        const float* plane = i < plane_count ? planes + i * 4 : padding;
+        frustum.a[i] = plane[0];
+        frustum.b[i] = plane[1];
+        frustum.c[i] = plane[2];
+        frustum.d[i] = plane[3];
+        frustum.abs_a[i] = fabsf(plane[0]);
+        frustum.abs_b[i] = fabsf(plane[1]);
+        frustum.abs_c[i] = fabsf(plane[2]);
+    }
+
+    int stack[MAX_DEPTH + 2];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size) {
+        // entries below zero are ~index of a node under a subtree already found inside
+        int entry = stack[--stack_size];
+        int index = entry < 0 ? ~entry : entry;
+        const Node& node = scene.nodes[index];
+        Containment containment = entry < 0 ? INSIDE : ClassifyBox(frustum, node.min, node.max);
+        if (containment == OUTSIDE) {
+            continue;
+        }
+        if (node.count == 0 && containment != INSIDE) {
+            stack[stack_size++] = node.first + 1;
+            stack[stack_size++] = node.first;
+            continue;
+        }
+        if (node.count == 0 && scene.scattered[index]) {
+            // no single run to read, walk down to the subtrees that still have one
+            stack[stack_size++] = ~(node.first + 1);
+            stack[stack_size++] = ~node.first;
+            continue;
+        }
+
+        // a leaf or an unscattered subtree fully inside: its objects are the contiguous run between its leftmost and
+        // rightmost leaves
+        const Node* leftmost = &node;
+        while (leftmost->count == 0) {
+            leftmost = &scene.nodes[leftmost->first];
+        }
+        const Node* rightmost = &node;
+        while (rightmost->count == 0) {
+            rightmost = &scene.nodes[rightmost->first + 1];
+        }
+        for (int i = leftmost->first; i < rightmost->first + rightmost->count; ++i) {
+            const Object& object = scene.objects[i];
+            if (!object.invertible) {
+                continue;
+            }
+            if (containment == INSIDE || ClassifyBox(frustum, object.bounds_min, object.bounds_max) != OUTSIDE) {
+                scene.selection.push_back(object.handle);
+            }
+        }
+    }
+
+    *out_handles = scene.selection.empty() ? NULL : &scene.selection[0];
+    return (int)scene.selection.size();
+}
+
+} // namespace Picking
@@ -0,0 +1,26 @@
+#pragma once
+
+// Native picking for the Lua module: objects registered with a world matrix and a local box or sphere,
+// kept in a bounding volume hierarchy over their world bounds.
+// Matrices are column-major float[16] like ImGuizmo. Handles are positive integers, 0 is never a handle.
+// Adding or removing an object updates the hierarchy in place, matrix changes refit it lazily on the next query.
+// It is rebuilt only once these updates made it too slow to traverse.
+
+namespace Picking
+{
+    int AddAABB(const float* matrix, const float* min, const float* max);
+    int AddSphere(const float* matrix, const float* center, float radius);
+    bool SetMatrix(int handle, const float* matrix);
+    bool Remove(int handle);
+    void Clear();
+    int GetCount();
+
+    // nearest object hit by the ray at a distance in [0, max_distance], 0 when none.
+    // ray_direction must be normalized for distance to be in world units
+    int Raycast(const float* ray_origin, const float* ray_direction, float max_distance, float* distance);
+
+    // handles of the objects whose world bounds touch the convex volume of up to 8 planes (a, b, c, d each, a point is
+    // inside when a * x + b * y + c * z + d >= 0), in no particular order. Returns the count, *out_handles points to
+    // a buffer owned by the module that stays valid until the next call
+    int SelectInPlanes(const float* planes, int plane_count, const int** out_handles);
+}
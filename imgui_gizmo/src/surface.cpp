@@ -0,0 +1,482 @@
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "surface.h"
+#include "bvh_util.h"
+
+namespace Surface
+{
+
+using namespace Bvh;
+
+// edge form used by the Moller-Trumbore test
+struct Triangle
+{
+    float v0[3];
+    float e1[3]; // v1 - v0
+    float e2[3]; // v2 - v0
+    int index;   // triangle of the mesh, to refit after the positions changed
+};
+
+struct Mesh
+{
+    float matrix[16];
+    float inverse[16];            // world to local, rays are tested in local space
+    float bounds_min[3];          // world bounds
+    float bounds_max[3];
+    std::vector<Triangle> triangles; // in leaf order
+    std::vector<Node> nodes;
+    std::vector<int> indices;     // 3 per triangle, empty for a triangle list
+    int vertex_count;
+    int handle;
+    bool enabled;
+    bool invertible;
+};
+
+static const int MAX_LEAF_SIZE = 4;
+static const int BIN_COUNT = 12;
+static const int MAX_DEPTH = 60; // deeper nodes become leaves, so traversal stacks have a fixed size
+
+struct Scene
+{
+    std::vector<Mesh> meshes; // dense, swap-removed
+    HandleTable handles;
+    int triangle_count = 0;
+};
+
+static Scene g_Scene;
+
+static void GrowTriangle(float* min, float* max, const Triangle& triangle)
+{
+    for (int i = 0; i < 3; ++i) {
+        float v0 = triangle.v0[i];
+        float v1 = v0 + triangle.e1[i];
+        float v2 = v0 + triangle.e2[i];
+        min[i] = Min(min[i], Min(v0, Min(v1, v2)));
+        max[i] = Max(max[i], Max(v0, Max(v1, v2)));
+    }
+}
+
+static float Centroid(const Triangle& triangle, int axis)
+{
+    return triangle.v0[axis] + (triangle.e1[axis] + triangle.e2[axis]) * (1.0f / 3.0f);
+}
+
+static void Cross(const float* a, const float* b, float* out)
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static float Dot(const float* a, const float* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// world bounds from the root of the local hierarchy: a transformed box keeps its center, extents are summed over the absolute matrix
+static void UpdateWorld(Mesh& mesh)
+{
+    mesh.invertible = InverseAffine(mesh.matrix, mesh.inverse);
+    if (!mesh.invertible || mesh.nodes.empty()) {
+        ClearBounds(mesh.bounds_min, mesh.bounds_max);
+        return;
+    }
+    const float* m = mesh.matrix;
+    const Node& root = mesh.nodes[0];
+    for (int i = 0; i < 3; ++i) {
+        float center = m[12 + i];
+        float extent = 0.0f;
+        for (int j = 0; j < 3; ++j) {
+            float local_center = (root.min[j] + root.max[j]) * 0.5f;
+            float local_extent = (root.max[j] - root.min[j]) * 0.5f;
+            center += m[j * 4 + i] * local_center;
+            extent += fabsf(m[j * 4 + i]) * local_extent;
+        }
+        mesh.bounds_min[i] = center - extent;
+        mesh.bounds_max[i] = center + extent;
+    }
+}
+
+static void SetTriangle(Triangle& triangle, const float* positions, int stride, int i0, int i1, int i2)
+{
+    const float* p0 = positions + (size_t)i0 * stride;
+    const float* p1 = positions + (size_t)i1 * stride;
+    const float* p2 = positions + (size_t)i2 * stride;
+    for (int i = 0; i < 3; ++i) {
+        triangle.v0[i] = p0[i];
+        triangle.e1[i] = p1[i] - p0[i];
+        triangle.e2[i] = p2[i] - p0[i];
+    }
+}
+
+// binned SAH along the longest centroid axis, false when keeping a leaf is cheaper
+static bool FindSplit(const Mesh& mesh, const Node& node, int* out_axis, float* out_position)
+{
+    const Triangle* triangles = &mesh.triangles[node.first];
+    float centroid_min[3];
+    float centroid_max[3];
+    ClearBounds(centroid_min, centroid_max);
+    for (int i = 0; i < node.count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            float c = Centroid(triangles[i], axis);
+            centroid_min[axis] = Min(centroid_min[axis], c);
+            centroid_max[axis] = Max(centroid_max[axis], c);
+        }
+    }
+    float extents[3] = { centroid_max[0] - centroid_min[0], centroid_max[1] - centroid_min[1], centroid_max[2] - centroid_min[2] };
+    int axis = extents[0] > extents[1] ? (extents[0] > extents[2] ? 0 : 2) : (extents[1] > extents[2] ? 1 : 2);
+    float extent = extents[axis];
+    if (extent <= 0.0f) {
+        return false;
+    }
+
+    struct Bin
+    {
+        float min[3];
+        float max[3];
+        int count;
+    };
+    Bin bins[BIN_COUNT];
+    for (int b = 0; b < BIN_COUNT; ++b) {
+        ClearBounds(bins[b].min, bins[b].max);
+        bins[b].count = 0;
+    }
+    float scale = BIN_COUNT / extent;
+    for (int i = 0; i < node.count; ++i) {
+        int b = (int)((Centroid(triangles[i], axis) - centroid_min[axis]) * scale);
+        b = b < BIN_COUNT - 1 ? b : BIN_COUNT - 1;
+        bins[b].count++;
+        GrowTriangle(bins[b].min, bins[b].max, triangles[i]);
+    }
+
+    float left_area[BIN_COUNT - 1];
+    int left_count[BIN_COUNT - 1];
+    float bounds_min[3];
+    float bounds_max[3];
+    ClearBounds(bounds_min, bounds_max);
+    int count = 0;
+    for (int b = 0; b < BIN_COUNT - 1; ++b) {
+        count += bins[b].count;
+        GrowBounds(bounds_min, bounds_max, bins[b].min, bins[b].max);
+        left_count[b] = count;
+        left_area[b] = Area(bounds_min, bounds_max);
+    }
+    // a leaf costs one test per triangle, a split one box test plus the triangles of both sides
+    const float area = Area(node.min, node.max);
+    float best_cost = (node.count - 1) * area;
+    bool found = false;
+    ClearBounds(bounds_min, bounds_max);
+    count = 0;
+    for (int b = BIN_COUNT - 1; b > 0; --b) {
+        count += bins[b].count;
+        GrowBounds(bounds_min, bounds_max, bins[b].min, bins[b].max);
+        if (left_count[b - 1] == 0 || count == 0) {
+            continue;
+        }
+        float cost = left_count[b - 1] * left_area[b - 1] + count * Area(bounds_min, bounds_max);
+        if (cost < best_cost) {
+            best_cost = cost;
+            *out_axis = axis;
+            *out_position = centroid_min[axis] + b / scale;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void ComputeLeafBounds(const Mesh& mesh, Node& node)
+{
+    ClearBounds(node.min, node.max);
+    for (int i = 0; i < node.count; ++i) {
+        GrowTriangle(node.min, node.max, mesh.triangles[node.first + i]);
+    }
+}
+
+static void Build(Mesh& mesh)
+{
+    mesh.nodes.clear();
+    int count = (int)mesh.triangles.size();
+    if (count == 0) {
+        return;
+    }
+    Node root;
+    root.first = 0;
+    root.count = count;
+    ComputeLeafBounds(mesh, root);
+    mesh.nodes.reserve(2 * (count / 2 + 1));
+    mesh.nodes.push_back(root);
+
+    struct Task
+    {
+        int node;
+        int depth;
+    };
+    std::vector<Task> tasks;
+    tasks.push_back({ 0, 0 });
+    while (!tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        Node node = mesh.nodes[task.node];
+        if (node.count <= 1 || task.depth >= MAX_DEPTH) {
+            continue;
+        }
+
+        int axis = 0;
+        float position = 0.0f;
+        int middle = node.first;
+        if (FindSplit(mesh, node, &axis, &position)) {
+            Triangle* triangles = &mesh.triangles[0];
+            int last = node.first + node.count - 1;
+            while (middle <= last) {
+                if (Centroid(triangles[middle], axis) < position) {
+                    middle++;
+                } else {
+                    std::swap(triangles[middle], triangles[last--]);
+                }
+            }
+        } else if (node.count > MAX_LEAF_SIZE) {
+            // cheaper as a leaf but too large, or all centroids in one point: split the range in two
+            middle = node.first + node.count / 2;
+        } else {
+            continue;
+        }
+        if (middle == node.first || middle == node.first + node.count) {
+            middle = node.first + node.count / 2;
+        }
+
+        Node left;
+        left.first = node.first;
+        left.count = middle - node.first;
+        ComputeLeafBounds(mesh, left);
+        Node right;
+        right.first = middle;
+        right.count = node.count - left.count;
+        ComputeLeafBounds(mesh, right);
+
+        int left_index = (int)mesh.nodes.size();
+        mesh.nodes[task.node].first = left_index;
+        mesh.nodes[task.node].count = 0;
+        mesh.nodes.push_back(left);
+        mesh.nodes.push_back(right);
+        tasks.push_back({ left_index, task.depth + 1 });
+        tasks.push_back({ left_index + 1, task.depth + 1 });
+    }
+}
+
+// children are stored after their parent, so walking backwards refits bottom-up
+static void Refit(Mesh& mesh)
+{
+    for (int i = (int)mesh.nodes.size() - 1; i >= 0; --i) {
+        Node& node = mesh.nodes[i];
+        if (node.count) {
+            ComputeLeafBounds(mesh, node);
+        } else {
+            const Node& left = mesh.nodes[node.first];
+            const Node& right = mesh.nodes[node.first + 1];
+            for (int axis = 0; axis < 3; ++axis) {
+                node.min[axis] = Min(left.min[axis], right.min[axis]);
+                node.max[axis] = Max(left.max[axis], right.max[axis]);
+            }
+        }
+    }
+}
+
+static Mesh* GetMesh(int handle)
+{
+    Scene& scene = g_Scene;
+    int index = scene.handles.Find(handle);
+    return index < 0 ? NULL : &scene.meshes[index];
+}
+
+int AddMesh(const float* matrix, const float* positions, int count, int stride, const int* indices, int index_count)
+{
+    Scene& scene = g_Scene;
+    int handle = scene.handles.Allocate((int)scene.meshes.size());
+    scene.meshes.push_back(Mesh());
+    Mesh& mesh = scene.meshes.back();
+    memcpy(mesh.matrix, matrix, sizeof(mesh.matrix));
+    mesh.vertex_count = count > 0 ? count : 0;
+    mesh.handle = handle;
+    mesh.enabled = true;
+
+    // triangles with an index out of range are dropped
+    int triangle_count = indices ? index_count / 3 : mesh.vertex_count / 3;
+    mesh.triangles.reserve(triangle_count);
+    for (int i = 0; i < triangle_count; ++i) {
+        int i0 = indices ? indices[i * 3] : i * 3;
+        int i1 = indices ? indices[i * 3 + 1] : i * 3 + 1;
+        int i2 = indices ? indices[i * 3 + 2] : i * 3 + 2;
+        if (i0 < 0 || i1 < 0 || i2 < 0 || i0 >= count || i1 >= count || i2 >= count) {
+            continue;
+        }
+        Triangle triangle;
+        SetTriangle(triangle, positions, stride, i0, i1, i2);
+        triangle.index = i;
+        mesh.triangles.push_back(triangle);
+    }
+    if (indices) {
+        mesh.indices.assign(indices, indices + triangle_count * 3);
+    }
+    Build(mesh);
+    UpdateWorld(mesh);
+    scene.triangle_count += (int)mesh.triangles.size();
+    return handle;
+}
+
+bool UpdateMesh(int handle, const float* positions, int count, int stride)
+{
+    Mesh* mesh = GetMesh(handle);
+    if (mesh == NULL || count != mesh->vertex_count) {
+        return false;
+    }
+    for (size_t i = 0; i < mesh->triangles.size(); ++i) {
+        Triangle& triangle = mesh->triangles[i];
+        const int* source = mesh->indices.empty() ? NULL : &mesh->indices[triangle.index * 3];
+        int first = triangle.index * 3;
+        SetTriangle(triangle, positions, stride, source ? source[0] : first, source ? source[1] : first + 1, source ? source[2] : first + 2);
+    }
+    Refit(*mesh);
+    UpdateWorld(*mesh);
+    return true;
+}
+
+bool SetMatrix(int handle, const float* matrix)
+{
+    Mesh* mesh = GetMesh(handle);
+    if (mesh == NULL) {
+        return false;
+    }
+    memcpy(mesh->matrix, matrix, sizeof(mesh->matrix));
+    UpdateWorld(*mesh);
+    return true;
+}
+
+bool SetEnabled(int handle, bool enabled)
+{
+    Mesh* mesh = GetMesh(handle);
+    if (mesh == NULL) {
+        return false;
+    }
+    mesh->enabled = enabled;
+    return true;
+}
+
+bool Remove(int handle)
+{
+    Scene& scene = g_Scene;
+    if (GetMesh(handle) == NULL) {
+        return false;
+    }
+    scene.triangle_count -= (int)scene.meshes[scene.handles.index[handle]].triangles.size();
+    SwapRemove(scene.meshes, scene.handles, handle);
+    return true;
+}
+
+void Clear()
+{
+    Scene& scene = g_Scene;
+    scene.meshes.clear();
+    scene.handles.Clear();
+    scene.triangle_count = 0;
+}
+
+int GetTriangleCount()
+{
+    return g_Scene.triangle_count;
+}
+
+// Moller-Trumbore, both sides. Distance along the ray, FLT_MAX when missed or not nearer than max_distance
+static float RayTriangle(const Triangle& triangle, const float* origin, const float* direction, float max_distance)
+{
+    float p[3];
+    Cross(direction, triangle.e2, p);
+    float det = Dot(triangle.e1, p);
+    if (det == 0.0f) {
+        return FLT_MAX;
+    }
+    float inv_det = 1.0f / det;
+    float s[3] = { origin[0] - triangle.v0[0], origin[1] - triangle.v0[1], origin[2] - triangle.v0[2] };
+    float u = Dot(s, p) * inv_det;
+    if (u < 0.0f || u > 1.0f) {
+        return FLT_MAX;
+    }
+    float q[3];
+    Cross(s, triangle.e1, q);
+    float v = Dot(direction, q) * inv_det;
+    if (v < 0.0f || u + v > 1.0f) {
+        return FLT_MAX;
+    }
+    float t = Dot(triangle.e2, q) * inv_det;
+    return t >= 0.0f && t < max_distance ? t : FLT_MAX;
+}
+
+int Raycast(const float* ray_origin, const float* ray_direction, float max_distance, float* distance, float* out_normal)
+{
+    Scene& scene = g_Scene;
+    float world_inv_direction[3];
+    for (int i = 0; i < 3; ++i) {
+        world_inv_direction[i] = 1.0f / ray_direction[i];
+    }
+
+    float best = max_distance;
+    const Mesh* best_mesh = NULL;
+    const Triangle* best_triangle = NULL;
+    for (size_t m = 0; m < scene.meshes.size(); ++m) {
+        const Mesh& mesh = scene.meshes[m];
+        if (!mesh.enabled || !mesh.invertible || mesh.nodes.empty() ||
+            RayBox(ray_origin, world_inv_direction, mesh.bounds_min, mesh.bounds_max, best) == FLT_MAX) {
+            continue;
+        }
+
+        // the local direction is not normalized, so distances along it stay world distances
+        float origin[3];
+        float direction[3];
+        float inv_direction[3];
+        TransformPoint(mesh.inverse, ray_origin, origin);
+        TransformVector(mesh.inverse, ray_direction, direction);
+        for (int i = 0; i < 3; ++i) {
+            inv_direction[i] = 1.0f / direction[i];
+        }
+
+        RaycastNodes<MAX_DEPTH + 2>(&mesh.nodes[0], origin, inv_direction, best, [&](const Node& node) {
+            for (int i = 0; i < node.count; ++i) {
+                const Triangle& triangle = mesh.triangles[node.first + i];
+                float t = RayTriangle(triangle, origin, direction, best);
+                if (t < FLT_MAX) {
+                    best = t;
+                    best_mesh = &mesh;
+                    best_triangle = &triangle;
+                }
+            }
+        });
+    }
+
+    if (best_triangle == NULL) {
+        return 0;
+    }
+    if (distance) {
+        *distance = best;
+    }
+    if (out_normal) {
+        // normals go through the inverse transpose, then face the ray origin
+        float local_normal[3];
+        Cross(best_triangle->e1, best_triangle->e2, local_normal);
+        const float* inv = best_mesh->inverse;
+        float normal[3];
+        for (int i = 0; i < 3; ++i) {
+            normal[i] = inv[i * 4] * local_normal[0] + inv[i * 4 + 1] * local_normal[1] + inv[i * 4 + 2] * local_normal[2];
+        }
+        float length = sqrtf(Dot(normal, normal));
+        float scale = (Dot(normal, ray_direction) > 0.0f ? -1.0f : 1.0f) / (length > 0.0f ? length : 1.0f);
+        for (int i = 0; i < 3; ++i) {
+            out_normal[i] = normal[i] * scale;
+        }
+    }
+    return best_mesh->handle;
+}
+
+} // namespace Surface
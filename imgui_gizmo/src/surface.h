@@ -0,0 +1,25 @@
+#pragma once
+
+// Surface placement for the Lua module: triangles of registered meshes, kept in local space in a bounding volume
+// hierarchy per mesh, for ray queries every drag frame.
+// Matrices are column-major float[16] like ImGuizmo. Handles are positive integers, 0 is never a handle.
+// Moving a mesh only changes its matrix. UpdateMesh refits the hierarchy for new positions of the same mesh.
+
+namespace Surface
+{
+    // count positions of 3 floats, stride floats apart. indices (index_count of them, 3 per triangle) can be NULL for
+    // a triangle list where every 3 positions make a triangle. Positions and indices are copied
+    int AddMesh(const float* matrix, const float* positions, int count, int stride, const int* indices, int index_count);
+    // new positions for the vertices of a mesh, same count as when it was added. The hierarchy is refit, not rebuilt
+    bool UpdateMesh(int handle, const float* positions, int count, int stride);
+    bool SetMatrix(int handle, const float* matrix);
+    // disabled meshes are skipped by Raycast, to leave out the mesh being dragged
+    bool SetEnabled(int handle, bool enabled);
+    bool Remove(int handle);
+    void Clear();
+    int GetTriangleCount();
+
+    // nearest triangle of an enabled mesh hit by the ray (both sides) at a distance in [0, max_distance], 0 when none.
+    // out_normal gets the world normal of the triangle facing the ray origin. Either output can be NULL
+    int Raycast(const float* ray_origin, const float* ray_direction, float max_distance, float* distance, float* out_normal);
+}
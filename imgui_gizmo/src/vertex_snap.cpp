@@ -0,0 +1,303 @@
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "vertex_snap.h"
+#include "bvh_util.h"
+
+namespace VertexSnap
+{
+
+using namespace Bvh;
+
+struct Point
+{
+    float p[3];
+};
+
+struct Mesh
+{
+    float matrix[16];
+    std::vector<Point> points; // local space, in leaf order
+    std::vector<Node> nodes;
+    int handle;
+    bool enabled;
+};
+
+static const int MAX_LEAF_SIZE = 16;
+static const int MAX_DEPTH = 48; // median splits halve the points, far more than any mesh needs
+static const int PLANE_COUNT = 5;
+
+struct Scene
+{
+    std::vector<Mesh> meshes; // dense, swap-removed
+    HandleTable handles;
+    int vertex_count = 0;
+};
+
+static Scene g_Scene;
+
+static void ComputeBounds(const Point* points, int count, float* min, float* max)
+{
+    ClearBounds(min, max);
+    for (int i = 0; i < count; ++i) {
+        GrowBounds(min, max, points[i].p, points[i].p);
+    }
+}
+
+// median split on the longest axis until leaves are small, points are sorted in place
+static void Build(Mesh& mesh)
+{
+    mesh.nodes.clear();
+    int count = (int)mesh.points.size();
+    Node root;
+    root.first = 0;
+    root.count = count;
+    ComputeBounds(&mesh.points[0], count, root.min, root.max);
+    mesh.nodes.reserve(2 * (count / MAX_LEAF_SIZE + 1));
+    mesh.nodes.push_back(root);
+
+    struct Task
+    {
+        int node;
+        int depth;
+    };
+    std::vector<Task> tasks;
+    tasks.push_back({ 0, 0 });
+    while (!tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        Node node = mesh.nodes[task.node];
+        if (node.count <= MAX_LEAF_SIZE || task.depth >= MAX_DEPTH) {
+            continue;
+        }
+
+        float extent[3] = { node.max[0] - node.min[0], node.max[1] - node.min[1], node.max[2] - node.min[2] };
+        int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+        Point* first = &mesh.points[node.first];
+        int half = node.count / 2;
+        std::nth_element(first, first + half, first + node.count, [axis](const Point& a, const Point& b) {
+            return a.p[axis] < b.p[axis];
+        });
+
+        Node left;
+        left.first = node.first;
+        left.count = half;
+        ComputeBounds(first, half, left.min, left.max);
+        Node right;
+        right.first = node.first + half;
+        right.count = node.count - half;
+        ComputeBounds(first + half, right.count, right.min, right.max);
+
+        int left_index = (int)mesh.nodes.size();
+        mesh.nodes[task.node].first = left_index;
+        mesh.nodes[task.node].count = 0;
+        mesh.nodes.push_back(left);
+        mesh.nodes.push_back(right);
+        tasks.push_back({ left_index, task.depth + 1 });
+        tasks.push_back({ left_index + 1, task.depth + 1 });
+    }
+}
+
+static Mesh* GetMesh(int handle)
+{
+    Scene& scene = g_Scene;
+    int index = scene.handles.Find(handle);
+    return index < 0 ? NULL : &scene.meshes[index];
+}
+
+int AddMesh(const float* matrix, const float* positions, int count, int stride)
+{
+    Scene& scene = g_Scene;
+    int handle = scene.handles.Allocate((int)scene.meshes.size());
+    scene.meshes.push_back(Mesh());
+    Mesh& mesh = scene.meshes.back();
+    memcpy(mesh.matrix, matrix, sizeof(mesh.matrix));
+    mesh.handle = handle;
+    mesh.enabled = true;
+    count = count > 0 ? count : 0;
+    mesh.points.resize(count);
+    for (int i = 0; i < count; ++i) {
+        memcpy(mesh.points[i].p, positions + (size_t)i * stride, sizeof(mesh.points[i].p));
+    }
+    if (count) {
+        Build(mesh);
+    }
+    scene.vertex_count += count;
+    return handle;
+}
+
+bool SetMatrix(int handle, const float* matrix)
+{
+    Mesh* mesh = GetMesh(handle);
+    if (mesh == NULL) {
+        return false;
+    }
+    memcpy(mesh->matrix, matrix, sizeof(mesh->matrix));
+    return true;
+}
+
+bool SetEnabled(int handle, bool enabled)
+{
+    Mesh* mesh = GetMesh(handle);
+    if (mesh == NULL) {
+        return false;
+    }
+    mesh->enabled = enabled;
+    return true;
+}
+
+bool Remove(int handle)
+{
+    Scene& scene = g_Scene;
+    if (GetMesh(handle) == NULL) {
+        return false;
+    }
+    scene.vertex_count -= (int)scene.meshes[scene.handles.index[handle]].points.size();
+    SwapRemove(scene.meshes, scene.handles, handle);
+    return true;
+}
+
+void Clear()
+{
+    Scene& scene = g_Scene;
+    scene.meshes.clear();
+    scene.handles.Clear();
+    scene.vertex_count = 0;
+}
+
+int GetVertexCount()
+{
+    return g_Scene.vertex_count;
+}
+
+// clip space of a mesh: rows of view_projection * matrix, row 3 gives w
+struct Query
+{
+    float clip[4][4];
+    float center_x;    // search circle in normalized device coordinates
+    float center_y;
+    float scale_x;     // pixels to normalized device coordinates
+    float scale_y;
+    float planes[PLANE_COUNT][4];
+};
+
+// side planes of the square around the search circle, plus w > 0 to keep what is in front of the camera
+static void ComputePlanes(Query& query, float pixel_radius)
+{
+    const float half_x = pixel_radius * query.scale_x;
+    const float half_y = pixel_radius * query.scale_y;
+    const float* x = query.clip[0];
+    const float* y = query.clip[1];
+    const float* w = query.clip[3];
+    for (int i = 0; i < 4; ++i) {
+        float offset_x = x[i] - query.center_x * w[i];
+        float offset_y = y[i] - query.center_y * w[i];
+        query.planes[0][i] = half_x * w[i] + offset_x;
+        query.planes[1][i] = half_x * w[i] - offset_x;
+        query.planes[2][i] = half_y * w[i] + offset_y;
+        query.planes[3][i] = half_y * w[i] - offset_y;
+        query.planes[4][i] = w[i];
+    }
+}
+
+static bool BoxOutside(const Query& query, const float* min, const float* max)
+{
+    const float cx = (min[0] + max[0]) * 0.5f, ex = (max[0] - min[0]) * 0.5f;
+    const float cy = (min[1] + max[1]) * 0.5f, ey = (max[1] - min[1]) * 0.5f;
+    const float cz = (min[2] + max[2]) * 0.5f, ez = (max[2] - min[2]) * 0.5f;
+    for (int i = 0; i < PLANE_COUNT; ++i) {
+        const float* plane = query.planes[i];
+        float d = plane[0] * cx + plane[1] * cy + plane[2] * cz + plane[3];
+        float r = fabsf(plane[0]) * ex + fabsf(plane[1]) * ey + fabsf(plane[2]) * ez;
+        if (d + r < 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FindNearest(const float* view_projection, const float* rect, float screen_x, float screen_y, float pixel_radius,
+    float* out_position, float* pixel_distance)
+{
+    Scene& scene = g_Scene;
+    Query query;
+    query.scale_x = 2.0f / rect[2];
+    query.scale_y = 2.0f / rect[3];
+    query.center_x = (screen_x - rect[0]) * query.scale_x - 1.0f;
+    query.center_y = 1.0f - (screen_y - rect[1]) * query.scale_y;
+
+    // squared distances in normalized device x units, y is rescaled to them to keep pixels square
+    const float aspect = query.scale_x / query.scale_y;
+    float best = pixel_radius * query.scale_x;
+    best *= best;
+    const Mesh* best_mesh = NULL;
+    const Point* best_point = NULL;
+    for (size_t m = 0; m < scene.meshes.size(); ++m) {
+        const Mesh& mesh = scene.meshes[m];
+        if (!mesh.enabled || mesh.nodes.empty()) {
+            continue;
+        }
+        for (int row = 0; row < 4; ++row) {
+            for (int column = 0; column < 4; ++column) {
+                query.clip[row][column] = view_projection[row] * mesh.matrix[column * 4] + view_projection[4 + row] * mesh.matrix[column * 4 + 1] +
+                    view_projection[8 + row] * mesh.matrix[column * 4 + 2] + view_projection[12 + row] * mesh.matrix[column * 4 + 3];
+            }
+        }
+        // the square shrinks to the best distance found so far
+        ComputePlanes(query, sqrtf(best) / query.scale_x);
+
+        int stack[MAX_DEPTH + 2];
+        int stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size) {
+            const Node& node = mesh.nodes[stack[--stack_size]];
+            if (BoxOutside(query, node.min, node.max)) {
+                continue;
+            }
+            if (node.count == 0) {
+                stack[stack_size++] = node.first + 1;
+                stack[stack_size++] = node.first;
+                continue;
+            }
+
+            bool improved = false;
+            for (int i = 0; i < node.count; ++i) {
+                const float* p = mesh.points[node.first + i].p;
+                const float* x = query.clip[0];
+                const float* y = query.clip[1];
+                const float* w = query.clip[3];
+                float clip_w = w[0] * p[0] + w[1] * p[1] + w[2] * p[2] + w[3];
+                if (clip_w <= 0.0f) {
+                    continue;
+                }
+                float inv_w = 1.0f / clip_w;
+                float dx = (x[0] * p[0] + x[1] * p[1] + x[2] * p[2] + x[3]) * inv_w - query.center_x;
+                float dy = ((y[0] * p[0] + y[1] * p[1] + y[2] * p[2] + y[3]) * inv_w - query.center_y) * aspect;
+                float distance = dx * dx + dy * dy;
+                if (distance < best) {
+                    best = distance;
+                    best_mesh = &mesh;
+                    best_point = &mesh.points[node.first + i];
+                    improved = true;
+                }
+            }
+            if (improved) {
+                ComputePlanes(query, sqrtf(best) / query.scale_x);
+            }
+        }
+    }
+
+    if (best_point == NULL) {
+        return false;
+    }
+    TransformPoint(best_mesh->matrix, best_point->p, out_position);
+    if (pixel_distance) {
+        *pixel_distance = sqrtf(best) / query.scale_x;
+    }
+    return true;
+}
+
+} // namespace VertexSnap
@@ -0,0 +1,24 @@
+#pragma once
+
+// Vertex snapping for the Lua module: vertex positions of registered meshes, kept in local space in a tree per mesh,
+// searched for the vertex nearest to a screen position.
+// Matrices are column-major float[16] like ImGuizmo. Handles are positive integers, 0 is never a handle.
+// Moving a mesh only changes its matrix, the tree is built once when the mesh is added.
+
+namespace VertexSnap
+{
+    // count positions of 3 floats, stride floats apart. The positions are copied
+    int AddMesh(const float* matrix, const float* positions, int count, int stride);
+    bool SetMatrix(int handle, const float* matrix);
+    // disabled meshes are skipped by FindNearest, to leave out the mesh being dragged
+    bool SetEnabled(int handle, bool enabled);
+    bool Remove(int handle);
+    void Clear();
+    int GetVertexCount();
+
+    // world position of the vertex of an enabled mesh that projects nearest to screen_pos, within pixel_radius and in
+    // front of the camera. view_projection and the rect (x, y, width, height) map world positions to screen
+    // coordinates the way ImGuizmo does. false when no vertex is in range, pixel_distance can be NULL
+    bool FindNearest(const float* view_projection, const float* rect, float screen_x, float screen_y, float pixel_radius,
+        float* out_position, float* pixel_distance);
+}